@@ -0,0 +1,307 @@
+// Library : C++20 coroutine interface for batched (asynchronous) prediction
+
+// A coroutine calls
+//
+//     float result = co_await executor.predict(sample);
+//
+// which queues the sample and suspends the coroutine (no thread is blocked).
+// A single dispatch thread collects queued samples into batches - a batch is
+// run as soon as it holds max_batch samples, or once its oldest sample has
+// waited max_delay_us - and runs the batch prediction function over the
+// whole batch at once. The waiting coroutines are then resumed (in parallel,
+// on the shared thread pool) with their results.
+
+// N.B. requires C++20 (compile users of this header with -std=c++20)
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_ASYNC_PREDICT_H
+#define ML_ASYNC_PREDICT_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/******************************************************************************/
+
+// coroutine return type for request handlers that nobody waits on (starts
+// running straight away and cleans up after itself when it finishes)
+
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() { return DetachedTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/******************************************************************************/
+
+class BatchedExecutor
+{
+public:
+
+    // predicts all rows of samples at once, one result per row (results is
+    // to be created by the function as samples.rows x 1, CV_32FC1)
+
+    typedef std::function<void (const cv::Mat& samples, cv::Mat& results)> BatchPredictor;
+
+    // what a coroutine co_awaits - holds the request while it is queued
+
+    class PredictAwaitable
+    {
+    public:
+
+        PredictAwaitable(BatchedExecutor& e, const cv::Mat& s)
+            : executor(e), sample(s), result(0) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            waiter = h;
+            executor.enqueue(this);
+        }
+
+        float await_resume()
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            return result;
+        }
+
+    private:
+
+        friend class BatchedExecutor;
+
+        BatchedExecutor& executor;
+        cv::Mat sample;
+        float result;
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+        std::chrono::steady_clock::time_point arrived;
+    };
+
+    BatchedExecutor(const BatchPredictor& batch_predictor, int batch_size = 64,
+                    int delay_us = 1000, ThreadPool& thread_pool = ThreadPool::global())
+        : predictor(batch_predictor), max_batch(std::max(1, batch_size)),
+          max_delay(std::chrono::microseconds(delay_us)), pool(thread_pool),
+          stopping(false), n_batches(0), n_samples(0)
+    {
+        dispatcher = std::thread(&BatchedExecutor::dispatch_loop, this);
+    }
+
+    // runs everything already queued then stops the dispatch thread
+
+    ~BatchedExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_one();
+        dispatcher.join();
+    }
+
+    // awaitable prediction of a single sample (a row, referenced - not copied
+    // - so it must stay valid until the co_await completes); all samples are
+    // to have the same number of columns and type, a sample unlike the rest
+    // of its batch being failed with an exception when awaited
+
+    PredictAwaitable predict(const cv::Mat& sample)
+    {
+        CV_Assert((sample.rows == 1) && (sample.cols > 0));
+
+        return PredictAwaitable(*this, sample);
+    }
+
+    // number of batches run and the mean number of samples in a batch
+
+    long batches() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return n_batches;
+    }
+
+    double mean_batch_size() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return n_batches ? ((double) n_samples / n_batches) : 0;
+    }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    BatchedExecutor(const BatchedExecutor&);
+    BatchedExecutor& operator=(const BatchedExecutor&);
+
+    void enqueue(PredictAwaitable* request)
+    {
+        bool first;
+        bool full;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            first = queued.empty();
+            request->arrived = Clock::now();
+            queued.push_back(request);
+            full = ((int) queued.size() >= max_batch);
+        }
+
+        // the first request needs the dispatcher to start its delay timer,
+        // a full batch needs it to stop waiting
+
+        if (first || full)
+        {
+            ready.notify_one();
+        }
+    }
+
+    void dispatch_loop()
+    {
+        std::vector<PredictAwaitable*> batch;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+
+                // wait for a full batch, or for the oldest request to have
+                // waited long enough, or shutdown
+
+                ready.wait(guard, [this]() { return stopping || !queued.empty(); });
+                while (!stopping && !queued.empty() && ((int) queued.size() < max_batch)
+                        && (Clock::now() < queued.front()->arrived + max_delay))
+                {
+                    ready.wait_until(guard, queued.front()->arrived + max_delay);
+                }
+
+                if (queued.empty())
+                {
+                    return; // stopping, with nothing left to do
+                }
+
+                int n = std::min((int) queued.size(), max_batch);
+                batch.assign(queued.begin(), queued.begin() + n);
+                queued.erase(queued.begin(), queued.begin() + n);
+
+                n_batches++;
+                n_samples += n;
+            }
+
+            run_batch(batch);
+        }
+    }
+
+    void run_batch(const std::vector<PredictAwaitable*>& batch)
+    {
+        int n = (int) batch.size();
+        const cv::Mat& first = batch[0]->sample;
+
+        // the row of each sample in the batch matrix (-1 for a sample whose
+        // size or type differs from the first, which cannot be batched with it)
+
+        std::vector<int> rows(n, -1);
+        int m = 0;
+        for (int i = 0; i < n; i++)
+        {
+            const cv::Mat& sample = batch[i]->sample;
+            if ((sample.rows == 1) && (sample.cols == first.cols) && (sample.type() == first.type()))
+            {
+                rows[i] = m++;
+            }
+        }
+
+        // gather the samples into one matrix and predict them all at once
+
+        cv::Mat samples(m, first.cols, first.type());
+        for (int i = 0; i < n; i++)
+        {
+            if (rows[i] >= 0)
+            {
+                cv::Mat row = samples.row(rows[i]);
+                batch[i]->sample.copyTo(row);
+            }
+        }
+
+        cv::Mat results;
+        std::exception_ptr error;
+        try
+        {
+            predictor(samples, results);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        if (!error && ((results.rows != m) || (results.cols != 1) || (results.type() != CV_32FC1)))
+        {
+            error = std::make_exception_ptr(cv::Exception(CV_StsBadSize,
+                                            "batch prediction did not give one CV_32FC1 result per sample",
+                                            "BatchedExecutor::run_batch", __FILE__, __LINE__));
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            if (rows[i] < 0)
+            {
+                batch[i]->error = std::make_exception_ptr(cv::Exception(CV_StsUnmatchedSizes,
+                                                          "sample differs in size or type from the rest of its batch",
+                                                          "BatchedExecutor::run_batch", __FILE__, __LINE__));
+            }
+            else if (error)
+            {
+                batch[i]->error = error;
+            }
+            else
+            {
+                batch[i]->result = results.at<float>(rows[i], 0);
+            }
+        }
+
+        // resume the waiting coroutines (each may well go on to queue its
+        // next request, which is fine - they only ever take the lock)
+
+        pool.parallel_for(0, n, [&batch](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                batch[i]->waiter.resume();
+            }
+        });
+    }
+
+    BatchPredictor predictor;
+    int max_batch;
+    Clock::duration max_delay;
+    ThreadPool& pool;
+
+    mutable std::mutex lock;
+    std::condition_variable ready;
+    std::vector<PredictAwaitable*> queued;   // oldest first
+    bool stopping;
+
+    long n_batches;
+    long n_samples;
+
+    std::thread dispatcher;
+};
+
+#endif // ML_ASYNC_PREDICT_H
@@ -0,0 +1,96 @@
+// Library : lazy (on the fly) augmentation of image samples for training
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "augment.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+/******************************************************************************/
+
+#define AUGMENT_ROWS_PER_TASK 64
+
+/******************************************************************************/
+
+ImageAugmenter::ImageAugmenter(int image_size, int shift, double rotation, uint64 s)
+    : size(image_size), max_shift(shift), max_rotation(rotation), seed(s)
+{
+}
+
+void ImageAugmenter::transform(const float* in, float* out,
+                               double dx, double dy, double angle) const
+{
+    // rotation about the image centre followed by the shift
+
+    cv::Point2f centre((size - 1) / 2.0f, (size - 1) / 2.0f);
+    cv::Mat m = cv::getRotationMatrix2D(centre, angle, 1.0);
+    m.at<double>(0, 2) += dx;
+    m.at<double>(1, 2) += dy;
+
+    // (the images are wrapped in place, nothing is copied)
+
+    cv::Mat src(size, size, CV_32FC1, const_cast<float*>(in));
+    cv::Mat dst(size, size, CV_32FC1, out);
+
+    cv::warpAffine(src, dst, m, cv::Size(size, size), cv::INTER_LINEAR,
+                   cv::BORDER_CONSTANT, cv::Scalar(0));
+}
+
+void ImageAugmenter::augment(const cv::Mat& data, cv::Mat& augmented, int epoch,
+                             ThreadPool& pool) const
+{
+    CV_Assert((data.cols == size * size) && (data.type() == CV_32FC1));
+
+    augmented.create(data.rows, data.cols, CV_32FC1);
+    cv::Mat out = augmented;
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            // a generator per (epoch, row) so no state is shared between threads
+
+            cv::RNG rng(seed + ((uint64) epoch << 32) + (uint64) r);
+
+            double dx = rng.uniform(-max_shift, max_shift + 1);
+            double dy = rng.uniform(-max_shift, max_shift + 1);
+            double angle = rng.uniform(-max_rotation, max_rotation);
+
+            transform(data.ptr<float>(r), out.ptr<float>(r), dx, dy, angle);
+        }
+    }, AUGMENT_ROWS_PER_TASK);
+}
+
+/******************************************************************************/
+
+AugmentedEpochs::AugmentedEpochs(const cv::Mat& data, const ImageAugmenter& a,
+                                 ThreadPool& p)
+    : source(data), augmenter(a), pool(p), current_epoch(-1)
+{
+    start(0);
+}
+
+void AugmentedEpochs::start(int epoch)
+{
+    pending.reset(new TaskGroup(pool));
+
+    cv::Mat* buffer = &buffers[epoch % 2];
+    pending->run([this, buffer, epoch]()
+    {
+        augmenter.augment(source, *buffer, epoch, pool);
+    });
+}
+
+const cv::Mat& AugmentedEpochs::next()
+{
+    pending->wait();
+    current_epoch++;
+
+    // generate the following epoch into the other buffer while this one is used
+
+    start(current_epoch + 1);
+
+    return buffers[current_epoch % 2];
+}
+
+/******************************************************************************/
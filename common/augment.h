@@ -0,0 +1,91 @@
+// Library : lazy (on the fly) augmentation of image samples for training
+
+// Each sample is a square image stored as one row (e.g. the 8x8 optdigits
+// and 16x16 semeion digits). Rather than storing every shifted / rotated
+// variant of every sample, a freshly transformed copy of the training set
+// is generated for each epoch - in the background on the thread pool while
+// the trainer works through the previous one - so at most two copies of the
+// training set are ever held in memory however many epochs are run.
+
+// The transform of a sample depends only on the seed, the epoch and the
+// sample's row, so results are the same whatever the number of threads.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_AUGMENT_H
+#define ML_AUGMENT_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <memory>
+
+/******************************************************************************/
+
+class ImageAugmenter
+{
+public:
+
+    // random shifts of up to max_shift pixels (in x and y) and rotations of
+    // up to max_rotation degrees (either way) of image_size x image_size images
+
+    ImageAugmenter(int image_size, int max_shift = 1, double max_rotation = 10,
+                   uint64 seed = 0x12345678);
+
+    // transform one image (image_size^2 values, row by row) to out
+
+    void transform(const float* in, float* out, double dx, double dy, double angle) const;
+
+    // randomly transform every row of data (CV_32FC1) for the given epoch -
+    // rows are transformed in parallel blocks on the pool
+
+    void augment(const cv::Mat& data, cv::Mat& augmented, int epoch,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    int image_size() const { return size; }
+
+private:
+
+    int size;
+    int max_shift;
+    double max_rotation;
+    uint64 seed;
+};
+
+/******************************************************************************/
+
+// the augmented training set epoch by epoch : next() returns the data for
+// the next epoch (waiting for it if it is still being generated) and starts
+// generating the epoch after that in the background
+
+class AugmentedEpochs
+{
+public:
+
+    AugmentedEpochs(const cv::Mat& data, const ImageAugmenter& augmenter,
+                    ThreadPool& pool = ThreadPool::global());
+
+    // (valid until the next call)
+
+    const cv::Mat& next();
+
+    int epoch() const { return current_epoch; }
+
+private:
+
+    AugmentedEpochs(const AugmentedEpochs&);
+    AugmentedEpochs& operator=(const AugmentedEpochs&);
+
+    void start(int epoch);
+
+    const cv::Mat& source;
+    const ImageAugmenter& augmenter;
+    ThreadPool& pool;
+
+    cv::Mat buffers[2];     // the epoch in use and the one being generated
+    int current_epoch;      // epoch returned by the last next() (-1 none yet)
+    std::unique_ptr<TaskGroup> pending;  // (last, so drained before the buffers go)
+};
+
+#endif // ML_AUGMENT_H
@@ -0,0 +1,265 @@
+// Library : Bernoulli naive Bayes classifier for binary attributes, scored
+// with bitwise AND and population count
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "bernoulli_bayes.h"
+
+#include <algorithm>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/******************************************************************************/
+
+#define BERNOULLI_BAYES_PLANES 8   // bits of each quantised weight
+
+#define BERNOULLI_BAYES_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+static inline int popcount(uint64 x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int) ((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/******************************************************************************/
+
+BernoulliNaiveBayes::BernoulliNaiveBayes(double alpha, float threshold)
+    : alpha(alpha), threshold(threshold), n_dims(0), n_words(0)
+{
+}
+
+void BernoulliNaiveBayes::train(const cv::Mat& data, const cv::Mat& responses)
+{
+    CV_Assert((data.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == data.rows) && (data.rows > 0));
+
+    cv::Mat r = responses.reshape(1, data.rows);
+    n_dims = data.cols;
+    n_words = (n_dims + 63) / 64;
+
+    // the distinct class labels, in increasing order
+
+    labels.clear();
+    for (int i = 0; i < data.rows; i++)
+    {
+        labels.push_back((float) cvRound(r.at<float>(i, 0)));
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    // samples of each class, and how many of them have each attribute set
+
+    std::vector<int> counts(classes(), 0);
+    cv::Mat set_counts = cv::Mat::zeros(classes(), n_dims, CV_32SC1);
+
+    for (int i = 0; i < data.rows; i++)
+    {
+        int c = (int) (std::lower_bound(labels.begin(), labels.end(),
+                                        (float) cvRound(r.at<float>(i, 0))) - labels.begin());
+        counts[c]++;
+
+        const float* x = data.ptr<float>(i);
+        int* s = set_counts.ptr<int>(c);
+        for (int j = 0; j < n_dims; j++)
+        {
+            s[j] += (x[j] > threshold);
+        }
+    }
+
+    // smoothed probabilities, as weights of the set attributes plus a
+    // constant for each class
+
+    weights.create(classes(), n_dims, CV_64FC1);
+    constants.resize(classes());
+
+    for (int c = 0; c < classes(); c++)
+    {
+        double constant = log((double) counts[c] / data.rows);
+        for (int j = 0; j < n_dims; j++)
+        {
+            double p = (set_counts.at<int>(c, j) + alpha) / (counts[c] + 2 * alpha);
+            weights.at<double>(c, j) = log(p) - log(1 - p);
+            constant += log(1 - p);
+        }
+        constants[c] = constant;
+    }
+
+    set_planes();
+}
+
+void BernoulliNaiveBayes::set_planes()
+{
+    const int levels = (1 << BERNOULLI_BAYES_PLANES) - 1;
+
+    planes.assign((size_t) classes() * BERNOULLI_BAYES_PLANES * n_words, 0);
+    offsets.resize(classes());
+    scales.resize(classes());
+
+    for (int c = 0; c < classes(); c++)
+    {
+        double min_weight, max_weight;
+        cv::minMaxLoc(weights.row(c), &min_weight, &max_weight);
+
+        offsets[c] = min_weight;
+        scales[c] = (max_weight > min_weight) ? (max_weight - min_weight) / levels : 1.0;
+
+        uint64* plane = &planes[(size_t) c * BERNOULLI_BAYES_PLANES * n_words];
+        for (int j = 0; j < n_dims; j++)
+        {
+            int q = cvRound((weights.at<double>(c, j) - offsets[c]) / scales[c]);
+            for (int b = 0; b < BERNOULLI_BAYES_PLANES; b++)
+            {
+                if (q & (1 << b))
+                {
+                    plane[b * n_words + (j >> 6)] |= (uint64) 1 << (j & 63);
+                }
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+
+void BernoulliNaiveBayes::pack(const float* sample, uint64* bits) const
+{
+    memset(bits, 0, n_words * sizeof(uint64));
+    for (int j = 0; j < n_dims; j++)
+    {
+        if (sample[j] > threshold)
+        {
+            bits[j >> 6] |= (uint64) 1 << (j & 63);
+        }
+    }
+}
+
+void BernoulliNaiveBayes::pack(const cv::Mat& samples, cv::Mat& packed, ThreadPool& pool) const
+{
+    CV_Assert((samples.type() == CV_32FC1) && (samples.cols == n_dims));
+
+    cv::Mat result(samples.rows, n_words * (int) sizeof(uint64), CV_8UC1);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            pack(samples.ptr<float>(i), (uint64*) result.ptr(i));
+        }
+    }, BERNOULLI_BAYES_ROWS_PER_TASK);
+
+    packed = result;
+}
+
+/******************************************************************************/
+
+float BernoulliNaiveBayes::predict_packed(const uint64* bits, double* scores) const
+{
+    int set_bits = 0;
+    for (int w = 0; w < n_words; w++)
+    {
+        set_bits += popcount(bits[w]);
+    }
+
+    int best = 0;
+    double best_score = -DBL_MAX;
+
+    for (int c = 0; c < classes(); c++)
+    {
+        // sum over the set bits of the quantised weights, plane by plane
+
+        const uint64* plane = &planes[(size_t) c * BERNOULLI_BAYES_PLANES * n_words];
+        int64 sum = 0;
+        for (int b = 0; b < BERNOULLI_BAYES_PLANES; b++, plane += n_words)
+        {
+            int n = 0;
+            for (int w = 0; w < n_words; w++)
+            {
+                n += popcount(bits[w] & plane[w]);
+            }
+            sum += (int64) n << b;
+        }
+
+        double score = constants[c] + offsets[c] * set_bits + scales[c] * sum;
+        if (scores)
+        {
+            scores[c] = score;
+        }
+        if (score > best_score)
+        {
+            best_score = score;
+            best = c;
+        }
+    }
+
+    return labels[best];
+}
+
+float BernoulliNaiveBayes::predict_exact(const uint64* bits, double* scores) const
+{
+    int best = 0;
+    double best_score = -DBL_MAX;
+
+    for (int c = 0; c < classes(); c++)
+    {
+        const double* w = weights.ptr<double>(c);
+        double score = constants[c];
+        for (int j = 0; j < n_dims; j++)
+        {
+            if (bits[j >> 6] & ((uint64) 1 << (j & 63)))
+            {
+                score += w[j];
+            }
+        }
+
+        if (scores)
+        {
+            scores[c] = score;
+        }
+        if (score > best_score)
+        {
+            best_score = score;
+            best = c;
+        }
+    }
+
+    return labels[best];
+}
+
+float BernoulliNaiveBayes::predict(const float* sample) const
+{
+    ScratchScope scope(ThreadPool::scratch_arena());
+    uint64* bits = ThreadPool::scratch_arena().allocate_array<uint64>(n_words);
+
+    pack(sample, bits);
+
+    return predict_packed(bits);
+}
+
+void BernoulliNaiveBayes::predict_packed(const cv::Mat& packed, cv::Mat& results,
+                                         ThreadPool& pool) const
+{
+    CV_Assert((packed.type() == CV_8UC1) && (packed.cols == n_words * (int) sizeof(uint64)));
+
+    cv::Mat result(packed.rows, 1, CV_32FC1);
+
+    pool.parallel_for(0, packed.rows, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            result.at<float>(i, 0) = predict_packed((const uint64*) packed.ptr(i));
+        }
+    }, BERNOULLI_BAYES_ROWS_PER_TASK);
+
+    results = result;
+}
+
+/******************************************************************************/
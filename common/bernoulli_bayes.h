@@ -0,0 +1,94 @@
+// Library : Bernoulli naive Bayes classifier for binary attributes, scored
+// with bitwise AND and population count
+
+// Each (binary) attribute is modelled as present with probability p (with
+// Laplace / additive smoothing) independently per class, so the log
+// likelihood of a sample x is
+//     log prior + sum log(1 - p) + sum over the set bits of x of w
+// with w = log p - log(1 - p) the weight of each attribute. Samples are
+// packed into 64-bit words (one bit per attribute) and each class's weights
+// are quantised to 8-bit fixed point and stored as 8 bit planes, so the sum
+// becomes, per plane b, 2^b * popcount(x AND plane_b) - a handful of word
+// operations per class rather than one multiply-add per attribute. The
+// POPCNT instruction is used where the compiler targets it (e.g. -mpopcnt or
+// -march=native). Unquantised (exact) scoring is also available, to check
+// the quantisation.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_BERNOULLI_BAYES_H
+#define ML_BERNOULLI_BAYES_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class BernoulliNaiveBayes
+{
+public:
+
+    // attributes > threshold are taken as set; alpha is the additive
+    // smoothing of the probabilities (1 = Laplace)
+
+    explicit BernoulliNaiveBayes(double alpha = 1.0, float threshold = 0.5f);
+
+    // train from samples (rows of data, CV_32FC1) and their classes
+    // (responses, integer valued CV_32FC1)
+
+    void train(const cv::Mat& data, const cv::Mat& responses);
+
+    // pack samples (CV_32FC1) into bits - rows x words() 64-bit words, held
+    // as CV_8UC1 (words() * 8 bytes per row); rows in parallel
+
+    void pack(const cv::Mat& samples, cv::Mat& packed,
+              ThreadPool& pool = ThreadPool::global()) const;
+    void pack(const float* sample, uint64* bits) const;
+
+    // class of one packed sample - and, if given, the log likelihood of each
+    // class into scores - by popcount over the bit planes, or exactly
+
+    float predict_packed(const uint64* bits, double* scores = NULL) const;
+    float predict_exact(const uint64* bits, double* scores = NULL) const;
+
+    // class of one sample (dims values, packed first)
+
+    float predict(const float* sample) const;
+
+    // class of every row of packed samples (results, CV_32FC1 column), rows
+    // in parallel blocks on the pool
+
+    void predict_packed(const cv::Mat& packed, cv::Mat& results,
+                        ThreadPool& pool = ThreadPool::global()) const;
+
+    int classes() const { return (int) labels.size(); }
+    int dims() const { return n_dims; }
+    int words() const { return n_words; }
+    float label(int c) const { return labels[c]; }
+
+protected:
+
+    // quantise the weights of each class into its bit planes
+
+    void set_planes();
+
+    double alpha;
+    float threshold;
+    int n_dims;
+    int n_words;
+
+    std::vector<float> labels;      // class labels, in increasing order
+    cv::Mat weights;                // log p - log(1 - p), classes x dims, CV_64FC1
+    std::vector<double> constants;  // log prior + sum log(1 - p)
+
+    // weight = offset + scale * (sum over b of 2^b bit b of plane b)
+
+    std::vector<uint64> planes;     // classes x planes x words
+    std::vector<double> offsets;
+    std::vector<double> scales;
+};
+
+#endif // ML_BERNOULLI_BAYES_H
@@ -0,0 +1,266 @@
+// Library : flattened decision tree over categorical attributes, split by
+// bitset membership tests
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "categorical_tree.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+
+#define CATEGORICAL_TREE_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+void FlatCategoricalTree::clear()
+{
+    nodes.clear();
+    masks.clear();
+    columns.clear();
+    categories.clear();
+}
+
+bool FlatCategoricalTree::compile(CvDTree& tree)
+{
+    clear();
+
+    const CvDTreeTrainData* data = tree.get_data();
+    if (!data || !tree.get_root())
+    {
+        return false;
+    }
+
+    const int* vtype = data->var_type->data.i;
+    const int* vidx = data->var_idx ? data->var_idx->data.i : 0;
+    const int* cmap = data->cat_map->data.i;
+    const int* cofs = data->cat_ofs->data.i;
+
+    // the sample column and (sorted, as in cat_map) values of each attribute
+
+    columns.resize(data->var_count);
+    categories.resize(data->var_count);
+    for (int vi = 0; vi < data->var_count; vi++)
+    {
+        int ci = vtype[vi];
+        if (ci < 0)
+        {
+            continue;
+        }
+
+        columns[vi] = vidx ? vidx[vi] : vi;
+        categories[vi].assign(cmap + cofs[ci], cmap + cofs[ci] + data->cat_count->data.i[ci]);
+    }
+
+    if (add_node(tree.get_root(), data, tree.get_pruned_tree_idx()) < 0)
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+int FlatCategoricalTree::add_node(const CvDTreeNode* node, const CvDTreeTrainData* data,
+                                  int pruned_tree_idx)
+{
+    int n = (int) nodes.size();
+
+    Node flat;
+    flat.var = -1;
+    flat.mask = flat.left = flat.right = flat.larger = -1;
+    flat.value = (float) node->value;
+    nodes.push_back(flat);
+
+    // a leaf, or pruned to one (as by CvDTree::predict)
+
+    if ((node->Tn <= pruned_tree_idx) || !node->left)
+    {
+        return n;
+    }
+
+    const CvDTreeSplit* split = node->split;
+    int ci = data->var_type->data.i[split->var_idx];
+    if (ci < 0)
+    {
+        return -1;
+    }
+
+    // the split's subset (bit set => left), inverted if the split is
+
+    int count = data->cat_count->data.i[ci];
+    int mask = (int) masks.size();
+    for (int w = 0; w < (count + 31) / 32; w++)
+    {
+        masks.push_back((unsigned int) split->subset[w]);
+    }
+    if (split->inversed)
+    {
+        for (int c = 0; c < count; c++)
+        {
+            masks[mask + (c >> 5)] ^= 1u << (c & 31);
+        }
+    }
+
+    int left = add_node(node->left, data, pruned_tree_idx);
+    int right = (left < 0) ? -1 : add_node(node->right, data, pruned_tree_idx);
+    if (right < 0)
+    {
+        return -1;
+    }
+
+    // (ties to the right, as by CvDTree::predict)
+
+    Node& added = nodes[n];
+    added.var = split->var_idx;
+    added.mask = mask;
+    added.left = left;
+    added.right = right;
+    added.larger = (node->right->sample_count < node->left->sample_count) ? left : right;
+
+    return n;
+}
+
+/******************************************************************************/
+
+void FlatCategoricalTree::encode(const float* sample, int* codes) const
+{
+    for (int vi = 0; vi < vars(); vi++)
+    {
+        const std::vector<int>& values = categories[vi];
+
+        float value = sample[columns[vi]];
+        int ivalue = cvRound(value);
+
+        std::vector<int>::const_iterator it = std::lower_bound(values.begin(), values.end(), ivalue);
+        codes[vi] = ((it != values.end()) && (*it == ivalue) && (ivalue == value))
+                    ? (int) (it - values.begin()) : -1;
+    }
+}
+
+float FlatCategoricalTree::predict(const float* sample) const
+{
+    ScratchScope scope(ThreadPool::scratch_arena());
+    int* codes = ThreadPool::scratch_arena().allocate_array<int>(vars());
+
+    encode(sample, codes);
+    return predict_codes(codes);
+}
+
+void FlatCategoricalTree::predict(const cv::Mat& samples, cv::Mat& results, ThreadPool& pool) const
+{
+    CV_Assert((samples.type() == CV_32FC1) && !empty());
+
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        ScratchScope scope(ThreadPool::scratch_arena());
+        int* codes = ThreadPool::scratch_arena().allocate_array<int>(vars());
+
+        for (int i = begin; i < end; i++)
+        {
+            encode(samples.ptr<float>(i), codes);
+            result.at<float>(i, 0) = predict_codes(codes);
+        }
+    }, CATEGORICAL_TREE_ROWS_PER_TASK);
+
+    results = result;
+}
+
+/******************************************************************************/
+
+void FlatCategoricalTree::write(cv::FileStorage& fs, const char* name) const
+{
+    // the nodes as the rows of an int matrix (the values separately), the
+    // categories of each attribute concatenated with their counts
+
+    cv::Mat node_table((int) nodes.size(), 5, CV_32SC1);
+    std::vector<float> values(nodes.size());
+    for (int n = 0; n < size(); n++)
+    {
+        int* row = node_table.ptr<int>(n);
+        row[0] = nodes[n].var;
+        row[1] = nodes[n].mask;
+        row[2] = nodes[n].left;
+        row[3] = nodes[n].right;
+        row[4] = nodes[n].larger;
+        values[n] = nodes[n].value;
+    }
+
+    std::vector<int> word_masks(masks.begin(), masks.end());
+    std::vector<int> counts, all_categories;
+    for (int vi = 0; vi < vars(); vi++)
+    {
+        counts.push_back((int) categories[vi].size());
+        all_categories.insert(all_categories.end(), categories[vi].begin(), categories[vi].end());
+    }
+
+    fs << name << "{"
+       << "nodes" << node_table
+       << "values" << values
+       << "masks" << word_masks
+       << "columns" << columns
+       << "counts" << counts
+       << "categories" << all_categories
+       << "}";
+}
+
+bool FlatCategoricalTree::read(const cv::FileStorage& fs, const char* name)
+{
+    clear();
+
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    cv::Mat node_table;
+    std::vector<float> values;
+    std::vector<int> word_masks, counts, all_categories;
+    node["nodes"] >> node_table;
+    node["values"] >> values;
+    node["masks"] >> word_masks;
+    node["columns"] >> columns;
+    node["counts"] >> counts;
+    node["categories"] >> all_categories;
+
+    if (node_table.empty() || (node_table.cols != 5) || (node_table.rows != (int) values.size()) ||
+            (counts.size() != columns.size()))
+    {
+        clear();
+        return false;
+    }
+
+    nodes.resize(node_table.rows);
+    for (int n = 0; n < size(); n++)
+    {
+        const int* row = node_table.ptr<int>(n);
+        nodes[n].var = row[0];
+        nodes[n].mask = row[1];
+        nodes[n].left = row[2];
+        nodes[n].right = row[3];
+        nodes[n].larger = row[4];
+        nodes[n].value = values[n];
+    }
+    masks.assign(word_masks.begin(), word_masks.end());
+
+    size_t offset = 0;
+    categories.resize(columns.size());
+    for (int vi = 0; vi < vars(); vi++)
+    {
+        if (offset + counts[vi] > all_categories.size())
+        {
+            clear();
+            return false;
+        }
+        categories[vi].assign(all_categories.begin() + offset,
+                              all_categories.begin() + offset + counts[vi]);
+        offset += counts[vi];
+    }
+
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,118 @@
+// Library : flattened decision tree over categorical attributes, split by
+// bitset membership tests
+
+// CvDTree resolves a categorical split at every node visited : the sample's
+// raw value (e.g. the hash of the string, as in dt_example1) is binary
+// searched for among the attribute's values in the training data's cat_map
+// to find its category code, and only then is the code tested against the
+// split's subset. Here the tree is compiled once, after training (or after
+// loading, e.g. tools/tree.yml), into an array of nodes each holding the
+// attribute tested, a bitmask over that attribute's category codes (bit set
+// => left child, the split's inversion folded in) and the indices of its
+// children. A sample is encoded into category codes once - one search per
+// attribute rather than one per node - and prediction is then a walk of
+// the array with a single shift and mask per node.
+
+// Nodes pruned by cross-validation (Tn <= the pruned tree index) are leaves,
+// as in CvDTree::predict. Only the primary split of each node is kept, so a
+// value not seen in training goes to the child with more training samples -
+// the same as CvDTree when it has no surrogate splits (use_surrogates false,
+// as for the car data). compile() fails for trees with ordered splits.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_CATEGORICAL_TREE_H
+#define ML_CATEGORICAL_TREE_H
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/ml/ml.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class FlatCategoricalTree
+{
+public:
+
+    // flatten a trained (or loaded) tree - returns false (leaving this tree
+    // empty) if any of its splits is on an ordered attribute
+
+    bool compile(CvDTree& tree);
+
+    // category code of each attribute of a sample (dims values, as given to
+    // CvDTree::predict) into codes (vars() ints) - -1 for a value not seen in
+    // training
+
+    void encode(const float* sample, int* codes) const;
+
+    // prediction from encoded category codes
+
+    float predict_codes(const int* codes) const
+    {
+        int n = 0;
+        while (nodes[n].var >= 0)
+        {
+            const Node& node = nodes[n];
+            int code = codes[node.var];
+
+            if (code < 0)
+            {
+                n = node.larger;
+            }
+            else
+            {
+                n = (masks[node.mask + (code >> 5)] >> (code & 31)) & 1 ? node.left : node.right;
+            }
+        }
+        return nodes[n].value;
+    }
+
+    // prediction for one sample (dims values)
+
+    float predict(const float* sample) const;
+    float predict(const cv::Mat& sample) const { return predict(sample.ptr<float>(0)); }
+
+    // prediction for every row of samples (results, CV_32FC1 column), each
+    // row encoded once, rows in parallel blocks on the pool
+
+    void predict(const cv::Mat& samples, cv::Mat& results,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    bool empty() const { return nodes.empty(); }
+    int size() const { return (int) nodes.size(); }
+    int vars() const { return (int) columns.size(); }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "categorical_tree") const;
+    bool read(const cv::FileStorage& fs, const char* name = "categorical_tree");
+
+protected:
+
+    struct Node
+    {
+        int var;        // attribute tested (-1 for a leaf)
+        int mask;       // offset of its bitmask in masks
+        int left;       // children (indices in nodes)
+        int right;
+        int larger;     // the child for a category not seen in training
+        float value;    // prediction (of a leaf)
+    };
+
+    void clear();
+
+    // append node (and, depth first, its subtree) - returns its index
+
+    int add_node(const CvDTreeNode* node, const CvDTreeTrainData* data, int pruned_tree_idx);
+
+    std::vector<Node> nodes;                    // root first
+    std::vector<unsigned int> masks;            // 32 categories per word
+
+    std::vector<int> columns;                   // sample column of each attribute
+    std::vector<std::vector<int> > categories;  // sorted values of each attribute
+};
+
+#endif // ML_CATEGORICAL_TREE_H
@@ -0,0 +1,100 @@
+// Library : streaming (row at a time) reader for the CSV sample files
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "csv_rows.h"
+
+#include <stdlib.h>
+
+/******************************************************************************/
+
+CSVRowReader::CSVRowReader(const char* filename) : n_rows(0)
+{
+    f = fopen(filename, "r");
+}
+
+CSVRowReader::~CSVRowReader()
+{
+    if (f)
+    {
+        fclose(f);
+    }
+}
+
+/******************************************************************************/
+
+bool CSVRowReader::next_row()
+{
+    if (!f)
+    {
+        return false;
+    }
+
+    char buffer[4096];
+
+    do
+    {
+        // read a whole line (in as many pieces as it takes)
+
+        line.clear();
+        while (fgets(buffer, sizeof(buffer), f))
+        {
+            line += buffer;
+            if (line[line.size() - 1] == '\n')
+            {
+                break;
+            }
+        }
+
+        if (line.empty())
+        {
+            return false; // end of file
+        }
+
+        // strip the line ending (and any trailing comma)
+
+        while (!line.empty() && ((line[line.size() - 1] == '\n')
+                                 || (line[line.size() - 1] == '\r')
+                                 || (line[line.size() - 1] == ',')))
+        {
+            line.erase(line.size() - 1);
+        }
+    }
+    while (line.empty());
+
+    // split into fields
+
+    starts.clear();
+    starts.push_back(0);
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        if (line[i] == ',')
+        {
+            line[i] = '\0';
+            starts.push_back(i + 1);
+        }
+    }
+
+    n_rows++;
+    return true;
+}
+
+float CSVRowReader::number(int i) const
+{
+    return (float) strtod(text(i), NULL);
+}
+
+bool CSVRowReader::numbers(int first, int n, float* values) const
+{
+    if (first + n > fields())
+    {
+        return false;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        values[i] = number(first + i);
+    }
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,61 @@
+// Library : streaming (row at a time) reader for the CSV sample files
+
+// Each line of a file is read and split into its comma separated fields,
+// which are then available as numbers or text until the next line is read -
+// so a sample can be transformed (e.g. projected or scaled) as it is loaded
+// rather than the whole file first being stored in its original form. Lines
+// can be of any length.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_CSV_ROWS_H
+#define ML_CSV_ROWS_H
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+class CSVRowReader
+{
+public:
+
+    explicit CSVRowReader(const char* filename);
+    ~CSVRowReader();
+
+    bool is_open() const { return f != NULL; }
+
+    // read the next (non blank) line, false at the end of the file
+
+    bool next_row();
+
+    // fields of the current line : count, as a number (0 if not numeric)
+    // and as text
+
+    int fields() const { return (int) starts.size(); }
+    float number(int i) const;
+    const char* text(int i) const { return &line[starts[i]]; }
+
+    // copy n fields, from field first onwards, as numbers into values
+    // (false if the line has fewer fields)
+
+    bool numbers(int first, int n, float* values) const;
+
+    // number of lines read so far
+
+    int rows() const { return n_rows; }
+
+private:
+
+    CSVRowReader(const CSVRowReader&);
+    CSVRowReader& operator=(const CSVRowReader&);
+
+    FILE* f;
+    std::string line;           // current line, commas replaced by '\0'
+    std::vector<size_t> starts; // start of each field within line
+    int n_rows;
+};
+
+#endif // ML_CSV_ROWS_H
@@ -0,0 +1,207 @@
+// Library : decision tree with its cross-validation pruning folds run in
+// parallel
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "dtree_prune.h"
+
+#include <float.h>
+#include <math.h>
+
+/******************************************************************************/
+
+ParallelPruneDTree::ParallelPruneDTree(ThreadPool& pool)
+    : pool(pool)
+{
+}
+
+/******************************************************************************/
+
+int ParallelPruneDTree::index_nodes(CvDTreeNode* node)
+{
+    int index = (int) nodes.size();
+    nodes.push_back(node);
+    left.push_back(-1);
+    right.push_back(-1);
+
+    if (node->left)
+    {
+        int l = index_nodes(node->left);
+        left[index] = l;
+        int r = index_nodes(node->right);
+        right[index] = r;
+    }
+
+    return index;
+}
+
+// for a fold, as CvDTree::update_tree_rnc() : the risk, error and number of
+// leaves of each subtree of sequence T (whose leaves are the true leaves and
+// the nodes cut at T or before) and the alpha at which each internal node
+// would be cut - returns the smallest such alpha
+
+double ParallelPruneDTree::update_fold(int node, int T, int fold, FoldState& state) const
+{
+    const CvDTreeNode* n = nodes[node];
+
+    if ((state.Tn[node] <= T) || (left[node] < 0))
+    {
+        state.complexity[node] = 1;
+        state.tree_risk[node] = n->cv_node_risk[fold];
+        state.tree_error[node] = n->cv_node_error[fold];
+        return DBL_MAX;
+    }
+
+    double min_alpha = update_fold(left[node], T, fold, state);
+    min_alpha = MIN(min_alpha, update_fold(right[node], T, fold, state));
+
+    // (left then right, as accumulated by OpenCV)
+
+    state.complexity[node] = state.complexity[left[node]] + state.complexity[right[node]];
+    state.tree_risk[node] = state.tree_risk[left[node]] + state.tree_risk[right[node]];
+    state.tree_error[node] = state.tree_error[left[node]] + state.tree_error[right[node]];
+
+    state.alpha[node] = (n->cv_node_risk[fold] - state.tree_risk[node]) /
+                        (state.complexity[node] - 1);
+
+    return MIN(min_alpha, state.alpha[node]);
+}
+
+// for a fold, as CvDTree::cut_tree() : cut (at T) every uncut internal node
+// whose alpha is the smallest - returns true if the root itself is cut
+
+bool ParallelPruneDTree::cut_fold(int node, int T, double min_alpha, FoldState& state) const
+{
+    if ((state.Tn[node] <= T) || (left[node] < 0))
+    {
+        return false;
+    }
+
+    if (state.alpha[node] <= min_alpha + FLT_EPSILON)
+    {
+        state.Tn[node] = T;
+        return (node == 0);
+    }
+
+    return cut_fold(left[node], T, min_alpha, state) ||
+           cut_fold(right[node], T, min_alpha, state);
+}
+
+/******************************************************************************/
+
+void ParallelPruneDTree::prune_cv()
+{
+    int cv_n = data->params.cv_folds;
+    int n = root->sample_count;
+
+    // currently, 1SE for regression is not implemented (as by OpenCV)
+
+    bool use_1se = data->params.use_1se_rule && data->is_classifier;
+
+    // the main tree sequence and its alphas (on the tree itself, as by
+    // OpenCV, as the pruned tree is read from the Tn of its nodes)
+
+    std::vector<double> ab;
+    for (;;)
+    {
+        int T = (int) ab.size();
+        double min_alpha = update_tree_rnc(T, -1);
+        if (cut_tree(T, -1, min_alpha))
+        {
+            break;
+        }
+        ab.push_back(min_alpha);
+    }
+
+    int tree_count = (int) ab.size();
+    int min_idx = -1;
+
+    if (tree_count > 0)
+    {
+        ab[0] = 0.;
+        for (int ti = 1; ti < tree_count - 1; ti++)
+        {
+            ab[ti] = sqrt(ab[ti] * ab[ti + 1]);
+        }
+        ab[tree_count - 1] = DBL_MAX * 0.5;
+
+        // index the nodes in pre-order
+
+        nodes.clear();
+        left.clear();
+        right.clear();
+        index_nodes(root);
+
+        // the sequence of each fold and its error at each alpha of the main
+        // sequence - the folds in parallel, each on its own state
+
+        std::vector<double> err((size_t) cv_n * tree_count, 0.);
+
+        pool.parallel_for(0, cv_n, [&](int begin, int end)
+        {
+            FoldState state;
+            for (int j = begin; j < end; j++)
+            {
+                state.Tn.resize(nodes.size());
+                for (size_t i = 0; i < nodes.size(); i++)
+                {
+                    state.Tn[i] = nodes[i]->cv_Tn[j];
+                }
+                state.complexity.assign(nodes.size(), 0);
+                state.alpha.assign(nodes.size(), 0.);
+                state.tree_risk.assign(nodes.size(), 0.);
+                state.tree_error.assign(nodes.size(), 0.);
+
+                int tj = 0, tk = 0;
+                for (; tk < tree_count; tj++)
+                {
+                    double min_alpha = update_fold(0, tj, j, state);
+                    if (cut_fold(0, tj, min_alpha, state))
+                    {
+                        min_alpha = DBL_MAX;
+                    }
+
+                    for (; tk < tree_count; tk++)
+                    {
+                        if (ab[tk] > min_alpha)
+                        {
+                            break;
+                        }
+                        err[(size_t) j * tree_count + tk] = state.tree_error[0];
+                    }
+                }
+            }
+        }, 1);
+
+        // merge : the total error over the folds of each subtree, choosing
+        // the best (applying the 1SE rule if required)
+
+        double min_err = 0, min_err_se = 0;
+        for (int ti = 0; ti < tree_count; ti++)
+        {
+            double sum_err = 0;
+            for (int j = 0; j < cv_n; j++)
+            {
+                sum_err += err[(size_t) j * tree_count + ti];
+            }
+            if ((ti == 0) || (sum_err < min_err))
+            {
+                min_err = sum_err;
+                min_idx = ti;
+                if (use_1se)
+                {
+                    min_err_se = sqrt(sum_err * (n - sum_err));
+                }
+            }
+            else if (sum_err < min_err + min_err_se)
+            {
+                min_idx = ti;
+            }
+        }
+    }
+
+    pruned_tree_idx = min_idx;
+    free_prune_data(data->params.truncate_pruned_tree != 0);
+}
+
+/******************************************************************************/
@@ -0,0 +1,73 @@
+// Library : decision tree with its cross-validation pruning folds run in
+// parallel
+
+// With cv_folds > 0 a CvDTree is pruned by cost-complexity [Breiman et al.
+// 1984] : the sequence of ever smaller subtrees of the full tree (and the
+// complexity parameter alpha at which each is reached) is found, then for
+// each fold the same sequence is found from that fold's node risks (the
+// statistics of the tree grown without the fold, gathered while the full
+// tree is grown), the held out fold's error is read off at each alpha, and
+// the subtree with the least total error (or, with the 1SE rule, the
+// smallest within one standard error of it) is kept. OpenCV runs the folds
+// one after another since the per fold sequences are built in scratch
+// fields of the tree nodes themselves. Here the nodes are indexed once and
+// each fold keeps its own copies of those fields, so the folds run
+// concurrently on the pool and their errors are then merged - the same
+// arithmetic in the same order per fold, so exactly the same subtree is
+// chosen (pruned_tree_idx) as by CvDTree.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_DTREE_PRUNE_H
+#define ML_DTREE_PRUNE_H
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/ml/ml.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class ParallelPruneDTree : public CvDTree
+{
+public:
+
+    explicit ParallelPruneDTree(ThreadPool& pool = ThreadPool::global());
+
+protected:
+
+    virtual void prune_cv();
+
+    // a fold's copy of the per node pruning state
+
+    struct FoldState
+    {
+        std::vector<int> Tn;
+        std::vector<int> complexity;
+        std::vector<double> alpha;
+        std::vector<double> tree_risk;
+        std::vector<double> tree_error;
+    };
+
+    // add node and its subtree to nodes (returns its index)
+
+    int index_nodes(CvDTreeNode* node);
+
+    // update_tree_rnc() / cut_tree() of CvDTree for one fold, on its state
+
+    double update_fold(int node, int T, int fold, FoldState& state) const;
+    bool cut_fold(int node, int T, double min_alpha, FoldState& state) const;
+
+    ThreadPool& pool;
+
+    // the nodes of the tree (in pre-order) and the indices of their children
+    // (-1 for leaves)
+
+    std::vector<CvDTreeNode*> nodes;
+    std::vector<int> left;
+    std::vector<int> right;
+};
+
+#endif // ML_DTREE_PRUNE_H
@@ -0,0 +1,129 @@
+// Library : feature selection by variance and (tree) variable importance
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "feature_select.h"
+
+/******************************************************************************/
+
+#define TRANSFORM_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+FeatureSelector::FeatureSelector() : n_inputs(0)
+{
+}
+
+void FeatureSelector::select(const cv::Mat& data, double min_variance,
+                             const cv::Mat& importance, double min_importance)
+{
+    CV_Assert(importance.empty() || ((int) importance.total() == data.cols));
+
+    cv::Mat importance64;
+    if (!importance.empty())
+    {
+        importance.reshape(1, 1).convertTo(importance64, CV_64F);
+    }
+
+    kept.clear();
+    n_inputs = data.cols;
+
+    for (int c = 0; c < data.cols; c++)
+    {
+        cv::Scalar mean, stddev;
+        cv::meanStdDev(data.col(c), mean, stddev);
+
+        if ((stddev[0] * stddev[0]) <= min_variance)
+        {
+            continue;
+        }
+        if (!importance64.empty() && (importance64.at<double>(0, c) < min_importance))
+        {
+            continue;
+        }
+        kept.push_back(c);
+    }
+}
+
+void FeatureSelector::select_columns(const std::vector<int>& columns, int inputs)
+{
+    kept = columns;
+    n_inputs = inputs;
+}
+
+/******************************************************************************/
+
+void FeatureSelector::transform(const cv::Mat& data, cv::Mat& compact, ThreadPool& pool) const
+{
+    CV_Assert((data.cols == n_inputs) && (data.type() == CV_32FC1));
+
+    // (a new matrix, so that data and compact may be the same object)
+
+    cv::Mat result(data.rows, selected(), CV_32FC1);
+    const int n_kept = selected();
+    const int* columns = kept.empty() ? NULL : &kept[0];
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            const float* in = data.ptr<float>(r);
+            float* out = result.ptr<float>(r);
+            for (int c = 0; c < n_kept; c++)
+            {
+                out[c] = in[columns[c]];
+            }
+        }
+    }, TRANSFORM_ROWS_PER_TASK);
+
+    compact = result;
+}
+
+cv::Mat FeatureSelector::transform(const cv::Mat& data) const
+{
+    cv::Mat compact;
+    transform(data, compact);
+    return compact;
+}
+
+cv::Mat FeatureSelector::transform_var_type(const cv::Mat& var_type) const
+{
+    CV_Assert((int) var_type.total() == n_inputs + 1);
+
+    const uchar* in = var_type.ptr<uchar>();
+    cv::Mat compact(selected() + 1, 1, CV_8U);
+
+    for (int c = 0; c < selected(); c++)
+    {
+        compact.at<uchar>(c, 0) = in[kept[c]];
+    }
+    compact.at<uchar>(selected(), 0) = in[n_inputs]; // the response
+
+    return compact;
+}
+
+/******************************************************************************/
+
+void FeatureSelector::write(cv::FileStorage& fs, const char* name) const
+{
+    fs << name << "{"
+       << "input_dims" << n_inputs
+       << "columns" << kept
+       << "}";
+}
+
+bool FeatureSelector::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    node["input_dims"] >> n_inputs;
+    node["columns"] >> kept;
+
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,72 @@
+// Library : feature selection by variance and (tree) variable importance
+
+// Attributes that never vary over the training set (e.g. the border pixels of
+// optdigits) or that a trained tree / forest found of little use (its
+// get_var_importance()) are dropped, and the data is remapped to a compact
+// matrix of only the remaining columns so that any classifier trained and
+// tested on it works on fewer attributes.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_FEATURE_SELECT_H
+#define ML_FEATURE_SELECT_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class FeatureSelector
+{
+public:
+
+    FeatureSelector();
+
+    // keep the columns of data (samples as rows, CV_32FC1) whose variance
+    // exceeds min_variance and, if an importance is given (1 x n or n x 1,
+    // any depth, e.g. from get_var_importance()), whose importance is at
+    // least min_importance
+
+    void select(const cv::Mat& data, double min_variance = 0,
+                const cv::Mat& importance = cv::Mat(), double min_importance = 0);
+
+    // keep the given columns (in order) of data with n_inputs columns
+
+    void select_columns(const std::vector<int>& columns, int n_inputs);
+
+    // copy the kept columns of every row of data (n x input_dims) giving
+    // n x selected() - rows are remapped in parallel blocks on the pool
+
+    void transform(const cv::Mat& data, cv::Mat& compact,
+                   ThreadPool& pool = ThreadPool::global()) const;
+
+    cv::Mat transform(const cv::Mat& data) const;
+
+    // the matching var_type for a tree / forest trained on the compact data,
+    // from the var_type (input_dims + 1 entries, response last) of the original
+
+    cv::Mat transform_var_type(const cv::Mat& var_type) const;
+
+    bool empty() const { return kept.empty(); }
+    int selected() const { return (int) kept.size(); }
+    int input_dims() const { return n_inputs; }
+
+    // original column index of each column of the compact data
+
+    const std::vector<int>& columns() const { return kept; }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "feature_select") const;
+    bool read(const cv::FileStorage& fs, const char* name = "feature_select");
+
+private:
+
+    std::vector<int> kept;
+    int n_inputs;
+};
+
+#endif // ML_FEATURE_SELECT_H
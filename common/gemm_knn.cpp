@@ -0,0 +1,176 @@
+// Library : k nearest neighbour search by blocked matrix multiplication
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "gemm_knn.h"
+
+#include <algorithm>
+
+#include <float.h>
+
+/******************************************************************************/
+
+#define GEMM_KNN_QUERY_ROWS 64      // queries per tile (and per task)
+#define GEMM_KNN_TRAINING_ROWS 512  // training samples per tile
+
+/******************************************************************************/
+
+// squared norm of each row of data (as a column)
+
+static cv::Mat row_norms(const cv::Mat& data, int begin, int end)
+{
+    cv::Mat norms(end - begin, 1, CV_32FC1);
+    for (int i = begin; i < end; i++)
+    {
+        const float* x = data.ptr<float>(i);
+        float norm = 0;
+        for (int j = 0; j < data.cols; j++)
+        {
+            norm += x[j] * x[j];
+        }
+        norms.at<float>(i - begin, 0) = norm;
+    }
+    return norms;
+}
+
+/******************************************************************************/
+
+GemmKNearest::GemmKNearest(const cv::Mat& samples, const cv::Mat& responses)
+    : training(samples), classes(responses)
+{
+    CV_Assert((samples.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == samples.rows));
+
+    norms = row_norms(training, 0, training.rows);
+}
+
+void GemmKNearest::find_nearest(const cv::Mat& samples, int k, cv::Mat& results,
+                                cv::Mat& neighbour_responses, cv::Mat* distances,
+                                cv::Mat* indices, ThreadPool& pool) const
+{
+    CV_Assert((samples.type() == CV_32FC1) && (samples.cols == training.cols));
+    CV_Assert((k > 0) && (k <= training.rows));
+
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+    cv::Mat neighbours(samples.rows, k, CV_32FC1);
+    cv::Mat neighbour_distances(samples.rows, k, CV_32FC1);
+    cv::Mat neighbour_indices(samples.rows, k, CV_32SC1);
+    cv::Mat labels = classes.reshape(1, training.rows);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        ScratchScope scope(ThreadPool::scratch_arena());
+        ScratchArena& arena = ThreadPool::scratch_arena();
+
+        // (the best so far and the products are written into scratch memory,
+        // reused query tile by query tile and training tile by training tile)
+
+        float* best_dist = arena.allocate_array<float>((size_t) GEMM_KNN_QUERY_ROWS * k);
+        int* best_index = arena.allocate_array<int>((size_t) GEMM_KNN_QUERY_ROWS * k);
+        float* products = arena.allocate_array<float>((size_t) GEMM_KNN_QUERY_ROWS *
+                                                      GEMM_KNN_TRAINING_ROWS);
+
+        // the task's queries in tiles of GEMM_KNN_QUERY_ROWS, so the tiling
+        // does not depend on how the pool divides the rows (e.g. a single
+        // task of all of them, with one thread)
+
+        for (int q0 = begin; q0 < end; q0 += GEMM_KNN_QUERY_ROWS)
+        {
+            int q1 = std::min(q0 + GEMM_KNN_QUERY_ROWS, end);
+            int n = q1 - q0;
+
+            cv::Mat queries = samples.rowRange(q0, q1);
+            cv::Mat query_norms = row_norms(samples, q0, q1);
+
+            std::fill(best_dist, best_dist + n * k, FLT_MAX);
+            std::fill(best_index, best_index + n * k, 0);
+
+            cv::Mat dots(n, GEMM_KNN_TRAINING_ROWS, CV_32FC1, products);
+
+            for (int t0 = 0; t0 < training.rows; t0 += GEMM_KNN_TRAINING_ROWS)
+            {
+                int t1 = std::min(t0 + GEMM_KNN_TRAINING_ROWS, training.rows);
+
+                // x.y for every query of the tile and training sample of the tile
+
+                cv::Mat tile_dots = dots.colRange(0, t1 - t0);
+                cv::gemm(queries, training.rowRange(t0, t1), 1, cv::Mat(), 0, tile_dots,
+                         cv::GEMM_2_T);
+
+                for (int i = 0; i < n; i++)
+                {
+                    const float* dot = tile_dots.ptr<float>(i);
+                    const float* y_norm = norms.ptr<float>(t0);
+                    float x_norm = query_norms.at<float>(i, 0);
+                    float* dist = best_dist + i * k;
+                    int* index = best_index + i * k;
+
+                    for (int t = t0; t < t1; t++)
+                    {
+                        float d = std::max(x_norm + y_norm[t - t0] - 2 * dot[t - t0], 0.0f);
+
+                        // insert into the (sorted) k best so far
+
+                        if (d < dist[k - 1])
+                        {
+                            int p = k - 1;
+                            while ((p > 0) && (dist[p - 1] > d))
+                            {
+                                dist[p] = dist[p - 1];
+                                index[p] = index[p - 1];
+                                p--;
+                            }
+                            dist[p] = d;
+                            index[p] = t;
+                        }
+                    }
+                }
+            }
+
+            // majority vote (ties go to the class of the nearer neighbour)
+
+            for (int i = 0; i < n; i++)
+            {
+                float* responses = neighbours.ptr<float>(q0 + i);
+                float* d = neighbour_distances.ptr<float>(q0 + i);
+                int* rows = neighbour_indices.ptr<int>(q0 + i);
+                for (int j = 0; j < k; j++)
+                {
+                    responses[j] = labels.at<float>(best_index[i * k + j], 0);
+                    d[j] = best_dist[i * k + j];
+                    rows[j] = best_index[i * k + j];
+                }
+
+                int best_votes = 0;
+                float best_class = responses[0];
+                for (int j = 0; j < k; j++)
+                {
+                    int votes = 0;
+                    for (int m = 0; m < k; m++)
+                    {
+                        votes += (responses[m] == responses[j]);
+                    }
+                    if (votes > best_votes)
+                    {
+                        best_votes = votes;
+                        best_class = responses[j];
+                    }
+                }
+                result.at<float>(q0 + i, 0) = best_class;
+            }
+        }
+    }, GEMM_KNN_QUERY_ROWS);
+
+    results = result;
+    neighbour_responses = neighbours;
+    if (distances)
+    {
+        *distances = neighbour_distances;
+    }
+    if (indices)
+    {
+        *indices = neighbour_indices;
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,54 @@
+// Library : k nearest neighbour search by blocked matrix multiplication
+
+// The squared distance between a query x and a training sample y is
+//     |x - y|^2 = |x|^2 + |y|^2 - 2 x.y
+// so with the norms of the training samples computed once, the distances
+// between a tile of queries and a tile of training samples come from one
+// matrix product (cv::gemm) of the two tiles - far faster than a loop over
+// every pair for wide samples (e.g. the 617 attributes of isolet). Each task
+// takes its queries a tile (of fixed size, however many threads there are)
+// at a time, multiplies the tile by each tile of training samples in turn
+// and keeps the k nearest of each query as it goes, so the full
+// queries x training distance matrix is never stored. The distances are
+// computed in float, so may differ from those of a direct difference by
+// rounding (ties between neighbours at almost equal distances may then be
+// broken differently).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_GEMM_KNN_H
+#define ML_GEMM_KNN_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+/******************************************************************************/
+
+class GemmKNearest
+{
+public:
+
+    // training samples (CV_32FC1, one per row) and their classes (CV_32FC1)
+
+    GemmKNearest(const cv::Mat& samples, const cv::Mat& responses);
+
+    // classes (results, majority vote - ties go to the class of the nearer
+    // neighbour) and the responses of the k nearest neighbours, nearest
+    // first (neighbour_responses, samples.rows x k) of each row of samples -
+    // and, if given, their squared distances (samples.rows x k) and their
+    // rows in the training samples (indices, samples.rows x k, CV_32SC1)
+
+    void find_nearest(const cv::Mat& samples, int k, cv::Mat& results,
+                      cv::Mat& neighbour_responses, cv::Mat* distances = NULL,
+                      cv::Mat* indices = NULL,
+                      ThreadPool& pool = ThreadPool::global()) const;
+
+private:
+
+    cv::Mat training;
+    cv::Mat classes;
+    cv::Mat norms;      // squared norm of each training sample (column)
+};
+
+#endif // ML_GEMM_KNN_H
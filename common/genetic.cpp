@@ -0,0 +1,260 @@
+// Library : genetic algorithm (GA) search over classifier hyperparameters and
+// feature subsets
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "genetic.h"
+
+#include <algorithm>
+
+#include <math.h>
+#include <stdio.h>
+
+/******************************************************************************/
+
+static bool fitter(const Genome& a, const Genome& b)
+{
+    return a.fitness > b.fitness;
+}
+
+/******************************************************************************/
+
+GeneticOptimizer::GeneticOptimizer(const std::vector<GeneRange>& r, int features,
+                                   const Fitness& f, const GeneticParams& p,
+                                   uint64 seed)
+    : ranges(r), n_features(features), fitness(f), params(p), rng(seed),
+      n_evaluations(0), n_cache_hits(0)
+{
+    CV_Assert((params.population > params.elite) && (params.tournament > 0) &&
+              (params.generations > 0));
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        CV_Assert(ranges[i].levels >= 2);
+        CV_Assert(!ranges[i].log_scale || (ranges[i].min_value > 0));
+    }
+}
+
+std::vector<double> GeneticOptimizer::values(const Genome& genome) const
+{
+    std::vector<double> v(ranges.size());
+
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        const GeneRange& r = ranges[i];
+        double t = (double) genome.levels[i] / (r.levels - 1);
+
+        v[i] = r.log_scale ? r.min_value * pow(r.max_value / r.min_value, t)
+               : r.min_value + t * (r.max_value - r.min_value);
+        if (r.integer)
+        {
+            v[i] = cvRound(v[i]);
+        }
+    }
+
+    return v;
+}
+
+std::string GeneticOptimizer::key(const Genome& genome) const
+{
+    std::string k;
+
+    for (size_t i = 0; i < genome.levels.size(); i++)
+    {
+        char level[16];
+        sprintf(level, "%d,", genome.levels[i]);
+        k += level;
+    }
+    k += '|';
+    for (size_t i = 0; i < genome.features.size(); i++)
+    {
+        k += genome.features[i] ? '1' : '0';
+    }
+
+    return k;
+}
+
+/******************************************************************************/
+
+// (at least one feature is always kept)
+
+static void ensure_feature(std::vector<uchar>& features, cv::RNG& rng)
+{
+    if (std::find(features.begin(), features.end(), 1) == features.end())
+    {
+        features[rng.uniform(0, (int) features.size())] = 1;
+    }
+}
+
+Genome GeneticOptimizer::random_genome()
+{
+    Genome g;
+
+    g.levels.resize(ranges.size());
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        g.levels[i] = rng.uniform(0, ranges[i].levels);
+    }
+
+    g.features.assign(n_features, 1);
+    if (params.select_features)
+    {
+        for (int i = 0; i < n_features; i++)
+        {
+            g.features[i] = (uchar) rng.uniform(0, 2);
+        }
+        ensure_feature(g.features, rng);
+    }
+
+    return g;
+}
+
+const Genome& GeneticOptimizer::select(const std::vector<Genome>& population)
+{
+    int best = rng.uniform(0, (int) population.size());
+
+    for (int i = 1; i < params.tournament; i++)
+    {
+        int other = rng.uniform(0, (int) population.size());
+        if (population[other].fitness > population[best].fitness)
+        {
+            best = other;
+        }
+    }
+
+    return population[best];
+}
+
+Genome GeneticOptimizer::breed(const std::vector<Genome>& population)
+{
+    Genome child = select(population);
+
+    // uniform crossover : each gene from either parent
+
+    if (rng.uniform(0.0, 1.0) < params.crossover_rate)
+    {
+        const Genome& other = select(population);
+
+        for (size_t i = 0; i < child.levels.size(); i++)
+        {
+            if (rng.uniform(0, 2))
+            {
+                child.levels[i] = other.levels[i];
+            }
+        }
+        for (size_t i = 0; i < child.features.size(); i++)
+        {
+            if (rng.uniform(0, 2))
+            {
+                child.features[i] = other.features[i];
+            }
+        }
+    }
+
+    // mutation
+
+    for (size_t i = 0; i < child.levels.size(); i++)
+    {
+        if (rng.uniform(0.0, 1.0) < params.mutation_rate)
+        {
+            child.levels[i] = rng.uniform(0, ranges[i].levels);
+        }
+    }
+    if (params.select_features)
+    {
+        for (size_t i = 0; i < child.features.size(); i++)
+        {
+            if (rng.uniform(0.0, 1.0) < params.feature_flip)
+            {
+                child.features[i] = !child.features[i];
+            }
+        }
+        ensure_feature(child.features, rng);
+    }
+
+    return child;
+}
+
+/******************************************************************************/
+
+void GeneticOptimizer::evaluate(std::vector<Genome>& population, ThreadPool& pool)
+{
+    // the distinct genomes not yet in the cache
+
+    std::vector<std::string> keys(population.size());
+    std::vector<int> pending;
+    {
+        std::lock_guard<std::mutex> guard(cache_lock);
+        std::map<std::string, int> queued;
+
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            keys[i] = key(population[i]);
+            if (!cache.count(keys[i]) && !queued.count(keys[i]))
+            {
+                queued[keys[i]] = (int) i;
+                pending.push_back((int) i);
+            }
+        }
+    }
+
+    n_evaluations += (int) pending.size();
+    n_cache_hits += (int) (population.size() - pending.size());
+
+    // evaluate them concurrently (a genome at a time, as each is a whole
+    // training run)
+
+    pool.parallel_for(0, (int) pending.size(), [&](int begin, int end)
+    {
+        for (int p = begin; p < end; p++)
+        {
+            const Genome& g = population[pending[p]];
+            double f = fitness(values(g), g.features);
+
+            std::lock_guard<std::mutex> guard(cache_lock);
+            cache[keys[pending[p]]] = f;
+        }
+    }, 1);
+
+    std::lock_guard<std::mutex> guard(cache_lock);
+    for (size_t i = 0; i < population.size(); i++)
+    {
+        population[i].fitness = cache[keys[i]];
+    }
+}
+
+Genome GeneticOptimizer::run(const Progress& progress, ThreadPool& pool)
+{
+    std::vector<Genome> population;
+    for (int i = 0; i < params.population; i++)
+    {
+        population.push_back(random_genome());
+    }
+
+    for (int generation = 0; generation < params.generations; generation++)
+    {
+        if (generation > 0)
+        {
+            // the elite carried over (the population is sorted, fittest first)
+            // and the rest bred from the last generation
+
+            std::vector<Genome> next(population.begin(), population.begin() + params.elite);
+            while ((int) next.size() < params.population)
+            {
+                next.push_back(breed(population));
+            }
+            population.swap(next);
+        }
+
+        evaluate(population, pool);
+        std::stable_sort(population.begin(), population.end(), fitter);
+
+        if (progress)
+        {
+            progress(generation, population[0]);
+        }
+    }
+
+    return population[0];
+}
+
+/******************************************************************************/
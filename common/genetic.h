@@ -0,0 +1,123 @@
+// Library : genetic algorithm (GA) search over classifier hyperparameters and
+// feature subsets
+
+// Each genome holds a value for every hyperparameter (one of a fixed number of
+// levels spread between its minimum and maximum, on a linear or log scale) and
+// a mask of the features (attributes) to use. Every generation the new
+// population is bred from the last - tournament selection, uniform crossover
+// and mutation, with the best few genomes carried over unchanged - and its
+// genomes are evaluated concurrently on the thread pool. As the genomes are
+// discrete, the same genome (e.g. a carried over one, or a child identical
+// to its parent) recurs often : fitness values are cached by genome so each
+// distinct genome is only ever evaluated once.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_GENETIC_H
+#define ML_GENETIC_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/******************************************************************************/
+
+// range of one hyperparameter
+
+struct GeneRange
+{
+    const char* name;
+    double min_value;
+    double max_value;
+    int levels;         // number of values from min_value to max_value (>= 2)
+    bool log_scale;     // values spaced geometrically (min_value > 0)
+    bool integer;       // values rounded to integers
+};
+
+struct Genome
+{
+    std::vector<int> levels;    // level of each hyperparameter
+    std::vector<uchar> features;// 1 = feature used
+    double fitness;
+
+    Genome() : fitness(0) {}
+};
+
+struct GeneticParams
+{
+    int population;         // genomes per generation
+    int generations;
+    int elite;              // best genomes carried over unchanged
+    int tournament;         // genomes drawn for each tournament selection
+    double crossover_rate;  // probability a child is bred from two parents
+    double mutation_rate;   // per hyperparameter probability of a new level
+    double feature_flip;    // per feature probability of being toggled
+    bool select_features;   // evolve the feature mask (or always use all)
+
+    GeneticParams() : population(40), generations(20), elite(2), tournament(3),
+        crossover_rate(0.8), mutation_rate(0.15), feature_flip(0.02),
+        select_features(true) {}
+};
+
+/******************************************************************************/
+
+class GeneticOptimizer
+{
+public:
+
+    // fitness of the decoded hyperparameter values and feature mask (larger
+    // is better) - called concurrently from several threads
+
+    typedef std::function<double (const std::vector<double>& values,
+                                  const std::vector<uchar>& features)> Fitness;
+
+    // called after each generation with its best genome
+
+    typedef std::function<void (int generation, const Genome& best)> Progress;
+
+    GeneticOptimizer(const std::vector<GeneRange>& ranges, int n_features,
+                     const Fitness& fitness, const GeneticParams& params = GeneticParams(),
+                     uint64 seed = 0x12345678);
+
+    // run every generation, returning the best genome found
+
+    Genome run(const Progress& progress = Progress(),
+               ThreadPool& pool = ThreadPool::global());
+
+    // hyperparameter values of a genome
+
+    std::vector<double> values(const Genome& genome) const;
+
+    // fitness evaluations actually run, and those answered from the cache
+
+    int evaluations() const { return n_evaluations; }
+    int cache_hits() const { return n_cache_hits; }
+
+private:
+
+    Genome random_genome();
+    const Genome& select(const std::vector<Genome>& population);
+    Genome breed(const std::vector<Genome>& population);
+    void evaluate(std::vector<Genome>& population, ThreadPool& pool);
+
+    std::string key(const Genome& genome) const;
+
+    std::vector<GeneRange> ranges;
+    int n_features;
+    Fitness fitness;
+    GeneticParams params;
+    cv::RNG rng;
+
+    std::map<std::string, double> cache;    // fitness of each genome seen
+    std::mutex cache_lock;
+    int n_evaluations;
+    int n_cache_hits;
+};
+
+#endif // ML_GENETIC_H
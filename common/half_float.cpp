@@ -0,0 +1,597 @@
+// Library : half precision (fp16) storage of sample matrices
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "half_float.h"
+
+#include "csv_rows.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+/******************************************************************************/
+
+#define HALF_ROWS_PER_TASK 256      // conversion of whole matrices
+#define HALF_SAMPLES_PER_TASK 32    // testing samples per kNN / SVM / MLP tile (and task)
+#define HALF_BLOCK_ROWS 256         // training samples (or support vectors)
+                                    // converted at a time
+
+/******************************************************************************/
+
+ushort float_to_half(float value)
+{
+    unsigned int x;
+    memcpy(&x, &value, sizeof(x));
+
+    unsigned int sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+
+    if (x >= 0x7f800000)
+    {
+        // infinity or NaN (kept as a NaN)
+
+        return (ushort) (sign | 0x7c00 | ((x > 0x7f800000) ? 0x200 : 0));
+    }
+    if (x >= 0x477ff000)
+    {
+        // too large : 65520 and above round to infinity
+
+        return (ushort) (sign | 0x7c00);
+    }
+    if (x < 0x38800000)
+    {
+        // below the smallest normal half (2^-14) : a subnormal, or zero
+
+        if (x < 0x33000000)
+        {
+            return (ushort) sign;
+        }
+
+        unsigned int mantissa = (x & 0x7fffff) | 0x800000;
+        int shift = 126 - (int) (x >> 23);
+        unsigned int h = mantissa >> shift;
+        unsigned int rest = mantissa & ((1u << shift) - 1);
+        unsigned int halfway = 1u << (shift - 1);
+
+        if ((rest > halfway) || ((rest == halfway) && (h & 1)))
+        {
+            h++;
+        }
+        return (ushort) (sign | h);
+    }
+
+    // normal : rebias the exponent, round the mantissa to 10 bits (a carry
+    // correctly moves into the exponent)
+
+    x -= 0x38000000;
+    unsigned int h = x >> 13;
+    unsigned int rest = x & 0x1fff;
+
+    if ((rest > 0x1000) || ((rest == 0x1000) && (h & 1)))
+    {
+        h++;
+    }
+    return (ushort) (sign | h);
+}
+
+float half_to_float(ushort value)
+{
+    unsigned int sign = (unsigned int) (value & 0x8000) << 16;
+    unsigned int exponent = (value >> 10) & 0x1f;
+    unsigned int mantissa = value & 0x3ff;
+    unsigned int x;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            x = sign;
+        }
+        else
+        {
+            // subnormal : normalise it
+
+            int e = -1;
+            do
+            {
+                e++;
+                mantissa <<= 1;
+            }
+            while (!(mantissa & 0x400));
+
+            x = sign | ((unsigned int) (112 - e) << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    }
+    else if (exponent == 31)
+    {
+        x = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+/******************************************************************************/
+
+void float_to_half(const float* in, ushort* out, int n)
+{
+    int i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*) (out + i), h);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        out[i] = float_to_half(in[i]);
+    }
+}
+
+void half_to_float(const ushort* in, float* out, int n)
+{
+    int i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i*) (in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+bool half_float_hardware()
+{
+#if defined(__F16C__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/******************************************************************************/
+
+cv::Mat to_half(const cv::Mat& data, ThreadPool& pool)
+{
+    CV_Assert(data.type() == CV_32FC1);
+
+    cv::Mat result(data.rows, data.cols, CV_16UC1);
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            float_to_half(data.ptr<float>(r), result.ptr<ushort>(r), data.cols);
+        }
+    }, HALF_ROWS_PER_TASK);
+
+    return result;
+}
+
+cv::Mat to_float(const cv::Mat& data, ThreadPool& pool)
+{
+    CV_Assert(data.type() == CV_16UC1);
+
+    cv::Mat result(data.rows, data.cols, CV_32FC1);
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            half_to_float(data.ptr<ushort>(r), result.ptr<float>(r), data.cols);
+        }
+    }, HALF_ROWS_PER_TASK);
+
+    return result;
+}
+
+bool load_half_csv(const char* filename, int n_samples, int n_attributes,
+                   cv::Mat& data, cv::Mat& responses)
+{
+    CSVRowReader reader(filename);
+    if (!reader.is_open())
+    {
+        return false;
+    }
+
+    data = cv::Mat(n_samples, n_attributes, CV_16UC1);
+    responses = cv::Mat(n_samples, 1, CV_32FC1);
+
+    std::vector<float> row(n_attributes + 1);
+
+    for (int line = 0; line < n_samples; line++)
+    {
+        if (!reader.next_row() || !reader.numbers(0, n_attributes + 1, &row[0]))
+        {
+            return false;
+        }
+
+        float_to_half(&row[0], data.ptr<ushort>(line), n_attributes);
+        responses.at<float>(line, 0) = row[n_attributes];
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+// rows [begin, end) of a half precision matrix as floats, one after another
+
+static void convert_rows(const cv::Mat& data, int begin, int end, float* out)
+{
+    for (int r = begin; r < end; r++)
+    {
+        half_to_float(data.ptr<ushort>(r), out + (size_t) (r - begin) * data.cols, data.cols);
+    }
+}
+
+/******************************************************************************/
+
+HalfKNearest::HalfKNearest(const cv::Mat& samples, const cv::Mat& responses)
+    : training(samples), classes(responses)
+{
+    CV_Assert((samples.type() == CV_16UC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == samples.rows));
+}
+
+void HalfKNearest::find_nearest(const cv::Mat& samples, int k, cv::Mat& results,
+                                cv::Mat& neighbour_responses, ThreadPool& pool) const
+{
+    CV_Assert((samples.type() == CV_16UC1) && (samples.cols == training.cols));
+    CV_Assert((k > 0) && (k <= training.rows));
+
+    int dims = training.cols;
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+    cv::Mat neighbours(samples.rows, k, CV_32FC1);
+    cv::Mat labels = classes.reshape(1, training.rows);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        ScratchScope scope(ThreadPool::scratch_arena());
+        ScratchArena& arena = ThreadPool::scratch_arena();
+
+        // (one tile of scratch memory, reused tile by tile)
+
+        float* tests = arena.allocate_array<float>((size_t) HALF_SAMPLES_PER_TASK * dims);
+        float* block = arena.allocate_array<float>((size_t) HALF_BLOCK_ROWS * dims);
+        float* best_dist = arena.allocate_array<float>((size_t) HALF_SAMPLES_PER_TASK * k);
+        int* best_index = arena.allocate_array<int>((size_t) HALF_SAMPLES_PER_TASK * k);
+
+        // the task's testing samples in tiles of HALF_SAMPLES_PER_TASK (a
+        // task may be all of them, with one thread), so only a tile of them
+        // is ever held as floats
+
+        for (int q0 = begin; q0 < end; q0 += HALF_SAMPLES_PER_TASK)
+        {
+            int q1 = std::min(q0 + HALF_SAMPLES_PER_TASK, end);
+            int n = q1 - q0;
+
+            convert_rows(samples, q0, q1, tests);
+            std::fill(best_dist, best_dist + n * k, FLT_MAX);
+            std::fill(best_index, best_index + n * k, 0);
+
+            // each block of training samples is converted once and compared with
+            // every testing sample of the tile while it is in cache
+
+            for (int t0 = 0; t0 < training.rows; t0 += HALF_BLOCK_ROWS)
+            {
+                int t1 = std::min(t0 + HALF_BLOCK_ROWS, training.rows);
+                convert_rows(training, t0, t1, block);
+
+                for (int i = 0; i < n; i++)
+                {
+                    const float* x = tests + (size_t) i * dims;
+                    float* dist = best_dist + i * k;
+                    int* index = best_index + i * k;
+
+                    for (int t = t0; t < t1; t++)
+                    {
+                        const float* y = block + (size_t) (t - t0) * dims;
+
+                        float d = 0;
+                        for (int j = 0; j < dims; j++)
+                        {
+                            float diff = x[j] - y[j];
+                            d += diff * diff;
+                        }
+
+                        // insert into the (sorted) k best so far
+
+                        if (d < dist[k - 1])
+                        {
+                            int p = k - 1;
+                            while ((p > 0) && (dist[p - 1] > d))
+                            {
+                                dist[p] = dist[p - 1];
+                                index[p] = index[p - 1];
+                                p--;
+                            }
+                            dist[p] = d;
+                            index[p] = t;
+                        }
+                    }
+                }
+            }
+
+            // majority vote (ties go to the class of the nearer neighbour)
+
+            for (int i = 0; i < n; i++)
+            {
+                float* responses = neighbours.ptr<float>(q0 + i);
+                for (int j = 0; j < k; j++)
+                {
+                    responses[j] = labels.at<float>(best_index[i * k + j], 0);
+                }
+
+                int best_votes = 0;
+                float best_class = responses[0];
+                for (int j = 0; j < k; j++)
+                {
+                    int votes = 0;
+                    for (int m = 0; m < k; m++)
+                    {
+                        votes += (responses[m] == responses[j]);
+                    }
+                    if (votes > best_votes)
+                    {
+                        best_votes = votes;
+                        best_class = responses[j];
+                    }
+                }
+                result.at<float>(q0 + i, 0) = best_class;
+            }
+        }
+    }, HALF_SAMPLES_PER_TASK);
+
+    results = result;
+    neighbour_responses = neighbours;
+}
+
+/******************************************************************************/
+
+void HalfSVM::store_half()
+{
+    CV_Assert((sv_total > 0) && (var_idx == NULL));
+
+    int dims = get_var_count();
+
+    half_sv.create(sv_total, dims, CV_16UC1);
+    for (int i = 0; i < sv_total; i++)
+    {
+        float_to_half(sv[i], half_sv.ptr<ushort>(i), dims);
+    }
+}
+
+void HalfSVM::kernel(const float* samples, int n_samples, const float* vectors,
+                     int n_vectors, double* values, int stride) const
+{
+    int dims = half_sv.cols;
+
+    for (int i = 0; i < n_samples; i++)
+    {
+        const float* x = samples + (size_t) i * dims;
+
+        for (int v = 0; v < n_vectors; v++)
+        {
+            const float* y = vectors + (size_t) v * dims;
+            double value;
+
+            if (params.kernel_type == RBF)
+            {
+                float d = 0;
+                for (int j = 0; j < dims; j++)
+                {
+                    float diff = x[j] - y[j];
+                    d += diff * diff;
+                }
+                value = exp(-params.gamma * d);
+            }
+            else
+            {
+                float dot = 0;
+                for (int j = 0; j < dims; j++)
+                {
+                    dot += x[j] * y[j];
+                }
+
+                switch (params.kernel_type)
+                {
+                case POLY:
+                    value = pow(params.gamma * dot + params.coef0, params.degree);
+                    break;
+                case SIGMOID:
+                    // (negated, as by CvSVMKernel::calc_sigmoid)
+                    value = -tanh(params.gamma * dot + params.coef0);
+                    break;
+                default: // LINEAR
+                    value = dot;
+                    break;
+                }
+            }
+
+            values[(size_t) i * stride + v] = value;
+        }
+    }
+}
+
+void HalfSVM::predict_half(const cv::Mat& samples, cv::Mat& results, ThreadPool& pool) const
+{
+    CV_Assert(!half_sv.empty() && (samples.type() == CV_16UC1) &&
+              (samples.cols == half_sv.cols));
+    CV_Assert((params.svm_type == C_SVC) || (params.svm_type == NU_SVC));
+
+    int dims = half_sv.cols;
+    int n_sv = half_sv.rows;
+    int class_count = class_labels->cols;
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        ScratchScope scope(ThreadPool::scratch_arena());
+        ScratchArena& arena = ThreadPool::scratch_arena();
+
+        // (one tile of scratch memory, reused tile by tile)
+
+        float* tests = arena.allocate_array<float>((size_t) HALF_SAMPLES_PER_TASK * dims);
+        float* block = arena.allocate_array<float>((size_t) HALF_BLOCK_ROWS * dims);
+        double* values = arena.allocate_array<double>((size_t) HALF_SAMPLES_PER_TASK * n_sv);
+        int* votes = arena.allocate_array<int>(class_count);
+
+        // the task's testing samples in tiles of HALF_SAMPLES_PER_TASK (a
+        // task may be all of them, with one thread)
+
+        for (int q0 = begin; q0 < end; q0 += HALF_SAMPLES_PER_TASK)
+        {
+            int q1 = std::min(q0 + HALF_SAMPLES_PER_TASK, end);
+            int n = q1 - q0;
+
+            // kernel value of every sample of the tile with every support vector
+
+            convert_rows(samples, q0, q1, tests);
+
+            for (int s0 = 0; s0 < n_sv; s0 += HALF_BLOCK_ROWS)
+            {
+                int s1 = std::min(s0 + HALF_BLOCK_ROWS, n_sv);
+                convert_rows(half_sv, s0, s1, block);
+                kernel(tests, n, block, s1 - s0, values + s0, n_sv);
+            }
+
+            // one against one voting over the decision functions (as CvSVM)
+
+            for (int i = 0; i < n; i++)
+            {
+                const double* k = values + (size_t) i * n_sv;
+                const CvSVMDecisionFunc* df = decision_func;
+
+                std::fill(votes, votes + class_count, 0);
+
+                for (int a = 0; a < class_count; a++)
+                {
+                    for (int b = a + 1; b < class_count; b++, df++)
+                    {
+                        double sum = -df->rho;
+                        for (int s = 0; s < df->sv_count; s++)
+                        {
+                            sum += df->alpha[s] * k[df->sv_index ? df->sv_index[s] : s];
+                        }
+                        votes[(sum > 0) ? a : b]++;
+                    }
+                }
+
+                int best = (int) (std::max_element(votes, votes + class_count) - votes);
+                result.at<float>(q0 + i, 0) = (float) class_labels->data.i[best];
+            }
+        }
+    }, HALF_SAMPLES_PER_TASK);
+
+    results = result;
+}
+
+/******************************************************************************/
+
+void HalfMLP::predict_half(const cv::Mat& samples, cv::Mat& outputs, ThreadPool& pool) const
+{
+    CV_Assert(layer_sizes && (samples.type() == CV_16UC1));
+    CV_Assert((activ_func == IDENTITY) || (activ_func == SIGMOID_SYM));
+
+    int l_count = layer_sizes->cols;
+    const int* sizes = layer_sizes->data.i;
+
+    CV_Assert(samples.cols == sizes[0]);
+
+    cv::Mat result(samples.rows, sizes[l_count - 1], CV_32FC1);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        std::vector<float> row(sizes[0]);
+
+        // the task's samples in tiles of HALF_SAMPLES_PER_TASK (a task may be
+        // all of them, with one thread), so only a tile is held as doubles
+
+        for (int q0 = begin; q0 < end; q0 += HALF_SAMPLES_PER_TASK)
+        {
+            int n = std::min(q0 + HALF_SAMPLES_PER_TASK, end) - q0;
+
+            // convert and scale the inputs (weights[0] holds a scale and shift
+            // per input)
+
+            cv::Mat layer(n, sizes[0], CV_64FC1);
+            for (int i = 0; i < n; i++)
+            {
+                half_to_float(samples.ptr<ushort>(q0 + i), &row[0], sizes[0]);
+
+                double* x = layer.ptr<double>(i);
+                for (int j = 0; j < sizes[0]; j++)
+                {
+                    x[j] = row[j] * weights[0][2 * j] + weights[0][2 * j + 1];
+                }
+            }
+
+            // each layer : weights[l] is a sizes[l - 1] x sizes[l] matrix followed
+            // by the sizes[l] biases
+
+            for (int l = 1; l < l_count; l++)
+            {
+                cv::Mat w(sizes[l - 1], sizes[l], CV_64FC1, weights[l]);
+                const double* bias = weights[l] + sizes[l - 1] * sizes[l];
+
+                cv::Mat sums;
+                cv::gemm(layer, w, 1, cv::Mat(), 0, sums);
+
+                for (int i = 0; i < n; i++)
+                {
+                    double* s = sums.ptr<double>(i);
+                    for (int j = 0; j < sizes[l]; j++)
+                    {
+                        double x = s[j] + bias[j];
+                        if (activ_func == SIGMOID_SYM)
+                        {
+                            double e = exp(-f_param1 * x);
+                            x = f_param2 * (1.0 - e) / (1.0 + e);
+                        }
+                        s[j] = x;
+                    }
+                }
+                layer = sums;
+            }
+
+            // scale the outputs (weights[l_count], a scale and shift per output)
+
+            for (int i = 0; i < n; i++)
+            {
+                const double* y = layer.ptr<double>(i);
+                float* out = result.ptr<float>(q0 + i);
+                for (int j = 0; j < sizes[l_count - 1]; j++)
+                {
+                    out[j] = (float) (y[j] * weights[l_count][2 * j] + weights[l_count][2 * j + 1]);
+                }
+            }
+        }
+    }, HALF_SAMPLES_PER_TASK);
+
+    outputs = result;
+}
+
+/******************************************************************************/
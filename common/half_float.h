@@ -0,0 +1,118 @@
+// Library : half precision (fp16) storage of sample matrices
+// (conversion, and kNN / SVM / neural network prediction from fp16 samples)
+
+// Samples are stored as IEEE 754 half precision values (16 bits, in CV_16UC1
+// matrices) rather than as CV_32FC1, halving the memory and bandwidth used by
+// large datasets at prediction time (OpenCV still trains from float data) -
+// about 3 significant decimal digits are kept, plenty for most attributes
+// (e.g. the speech data, scaled to -1 ... 1). The values are converted back
+// to float on the fly, a tile of rows at a time into per thread scratch
+// memory, within each kernel (distances, SVM kernels, network layers) - with
+// the F16C instructions where the compiler targets them (e.g. -mf16c or
+// -march=native) and in software otherwise.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_HALF_FLOAT_H
+#define ML_HALF_FLOAT_H
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/ml/ml.hpp"
+
+#include "threadpool.h"
+
+/******************************************************************************/
+
+// conversion of single values (round to nearest even) and of arrays
+
+ushort float_to_half(float value);
+float half_to_float(ushort value);
+
+void float_to_half(const float* in, ushort* out, int n);
+void half_to_float(const ushort* in, float* out, int n);
+
+// true if the array conversions use the F16C instructions
+
+bool half_float_hardware();
+
+// conversion of whole matrices (CV_32FC1 <-> CV_16UC1), rows in parallel
+
+cv::Mat to_half(const cv::Mat& data, ThreadPool& pool = ThreadPool::global());
+cv::Mat to_float(const cv::Mat& data, ThreadPool& pool = ThreadPool::global());
+
+// loads a CSV file of n_samples lines of attributes followed by the class
+// straight into half precision (no float copy of the data is ever stored)
+
+bool load_half_csv(const char* filename, int n_samples, int n_attributes,
+                   cv::Mat& data, cv::Mat& responses);
+
+/******************************************************************************/
+
+// k nearest neighbour classification (majority vote) with both the training
+// and testing samples in half precision
+
+class HalfKNearest
+{
+public:
+
+    // training samples (CV_16UC1, one per row) and their classes (CV_32FC1)
+
+    HalfKNearest(const cv::Mat& samples, const cv::Mat& responses);
+
+    // classes (results) and the responses of the k nearest neighbours, nearest
+    // first (neighbour_responses, samples.rows x k) of each row of samples
+
+    void find_nearest(const cv::Mat& samples, int k, cv::Mat& results,
+                      cv::Mat& neighbour_responses,
+                      ThreadPool& pool = ThreadPool::global()) const;
+
+private:
+
+    cv::Mat training;
+    cv::Mat classes;
+};
+
+/******************************************************************************/
+
+// an SVM classifier (C_SVC or NU_SVC), trained or loaded as usual, that also
+// keeps its support vectors in half precision to classify half precision
+// samples - the kernel is evaluated between blocks of samples and blocks of
+// support vectors, both converted on the fly
+
+class HalfSVM : public CvSVM
+{
+public:
+
+    // copy the support vectors to half precision (after train or load)
+
+    void store_half();
+
+    // class of each row of samples (CV_16UC1) as results (CV_32FC1 column)
+
+    void predict_half(const cv::Mat& samples, cv::Mat& results,
+                      ThreadPool& pool = ThreadPool::global()) const;
+
+private:
+
+    void kernel(const float* samples, int n_samples, const float* vectors,
+                int n_vectors, double* values, int stride) const;
+
+    cv::Mat half_sv;    // support vectors (CV_16UC1, one per row)
+};
+
+/******************************************************************************/
+
+// a neural network (IDENTITY or SIGMOID_SYM activation), trained or loaded as
+// usual, that can also run forward on half precision samples
+
+class HalfMLP : public CvANN_MLP
+{
+public:
+
+    // network outputs for each row of samples (CV_16UC1), CV_32FC1
+
+    void predict_half(const cv::Mat& samples, cv::Mat& outputs,
+                      ThreadPool& pool = ThreadPool::global()) const;
+};
+
+#endif // ML_HALF_FLOAT_H
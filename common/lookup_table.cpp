@@ -0,0 +1,152 @@
+// Library : dense lookup table compiled from a model over categorical
+// attributes
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "lookup_table.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+
+#define LOOKUP_TABLE_ENTRIES_PER_TASK 256
+
+/******************************************************************************/
+
+void CategoricalLookupTable::fit_categories(const cv::Mat& data)
+{
+    CV_Assert(data.type() == CV_32FC1);
+
+    categories.assign(data.cols, std::vector<float>());
+    for (int j = 0; j < data.cols; j++)
+    {
+        std::vector<float>& values = categories[j];
+        for (int i = 0; i < data.rows; i++)
+        {
+            values.push_back(data.at<float>(i, j));
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+
+    set_strides();
+    table.clear();
+}
+
+void CategoricalLookupTable::set_strides()
+{
+    strides.resize(categories.size());
+
+    size_t stride = 1;
+    for (int j = (int) categories.size() - 1; j >= 0; j--)
+    {
+        strides[j] = stride;
+        stride *= categories[j].size();
+    }
+}
+
+size_t CategoricalLookupTable::table_size(size_t max_entries) const
+{
+    size_t entries = 1;
+    for (size_t j = 0; j < categories.size(); j++)
+    {
+        if (categories[j].empty() || (categories[j].size() > max_entries / entries))
+        {
+            return 0;
+        }
+        entries *= categories[j].size();
+    }
+    return entries;
+}
+
+/******************************************************************************/
+
+bool CategoricalLookupTable::compile(const Model& model, size_t max_entries, ThreadPool& pool)
+{
+    size_t entries = table_size(max_entries);
+
+    table.clear();
+    if ((entries == 0) || categories.empty())
+    {
+        return false;
+    }
+
+    table.resize(entries);
+
+    // the sample of each entry, decoded from its index
+
+    pool.parallel_for(0, (int) entries, [&](int begin, int end)
+    {
+        cv::Mat sample(1, dims(), CV_32FC1);
+        for (int index = begin; index < end; index++)
+        {
+            size_t rest = index;
+            for (int j = 0; j < dims(); j++)
+            {
+                sample.at<float>(0, j) = categories[j][rest / strides[j]];
+                rest %= strides[j];
+            }
+            table[index] = model(sample);
+        }
+    }, LOOKUP_TABLE_ENTRIES_PER_TASK);
+
+    return true;
+}
+
+bool CategoricalLookupTable::encode(const float* sample, size_t& index) const
+{
+    index = 0;
+    for (size_t j = 0; j < categories.size(); j++)
+    {
+        const std::vector<float>& values = categories[j];
+        std::vector<float>::const_iterator it =
+            std::lower_bound(values.begin(), values.end(), sample[j]);
+
+        if ((it == values.end()) || (*it != sample[j]))
+        {
+            return false;
+        }
+        index += (it - values.begin()) * strides[j];
+    }
+    return true;
+}
+
+/******************************************************************************/
+
+void CategoricalLookupTable::write(cv::FileStorage& fs, const char* name) const
+{
+    fs << name << "{" << "categories" << "[";
+    for (size_t j = 0; j < categories.size(); j++)
+    {
+        fs << categories[j];
+    }
+    fs << "]" << "table" << table << "}";
+}
+
+bool CategoricalLookupTable::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    cv::FileNode values = node["categories"];
+    categories.assign(values.size(), std::vector<float>());
+    for (size_t j = 0; j < categories.size(); j++)
+    {
+        values[(int) j] >> categories[j];
+    }
+    node["table"] >> table;
+
+    set_strides();
+    if (table.size() != table_size(table.size()))
+    {
+        table.clear();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
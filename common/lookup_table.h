@@ -0,0 +1,95 @@
+// Library : dense lookup table compiled from a model over categorical
+// attributes
+
+// When every attribute is categorical and the product of the numbers of
+// categories is small (e.g. the car data : 4 * 4 * 4 * 3 * 3 * 3 = 1728
+// combinations) the prediction of any trained model for every possible
+// sample can simply be tabulated once. Each attribute's value is encoded as
+// its index among the (sorted) values seen in the training data, the codes
+// are combined into one mixed radix index
+//     index = sum over j of code_j * stride_j,  stride_j = product of the
+//                                               counts of attributes > j
+// and prediction is a single table read. compile() only builds the table
+// if it has at most max_entries entries (otherwise the model itself should
+// be used); samples with a value not seen in training cannot be looked up.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_LOOKUP_TABLE_H
+#define ML_LOOKUP_TABLE_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <functional>
+#include <vector>
+
+/******************************************************************************/
+
+#define LOOKUP_TABLE_MAX_ENTRIES (1 << 20)
+
+class CategoricalLookupTable
+{
+public:
+
+    // prediction of the model being compiled for one sample (1 x dims,
+    // CV_32FC1) - called concurrently from the threads of the pool
+
+    typedef std::function<float (const cv::Mat& sample)> Model;
+
+    // the categories (distinct values) of each column of data (samples as
+    // rows, CV_32FC1)
+
+    void fit_categories(const cv::Mat& data);
+
+    // number of entries a table over the categories would need (0 if more
+    // than max_entries)
+
+    size_t table_size(size_t max_entries = LOOKUP_TABLE_MAX_ENTRIES) const;
+
+    // tabulate model over every combination of categories - returns false
+    // (leaving the table empty) if that needs more than max_entries entries
+
+    bool compile(const Model& model, size_t max_entries = LOOKUP_TABLE_MAX_ENTRIES,
+                 ThreadPool& pool = ThreadPool::global());
+
+    // mixed radix index of a sample (dims values) - false if a value is not
+    // one of the categories
+
+    bool encode(const float* sample, size_t& index) const;
+
+    // prediction for a sample - false if it cannot be looked up
+
+    bool predict(const float* sample, float& result) const
+    {
+        size_t index;
+        if (!encode(sample, index))
+        {
+            return false;
+        }
+        result = table[index];
+        return true;
+    }
+
+    float predict_index(size_t index) const { return table[index]; }
+
+    bool empty() const { return table.empty(); }
+    size_t size() const { return table.size(); }
+    int dims() const { return (int) categories.size(); }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "lookup_table") const;
+    bool read(const cv::FileStorage& fs, const char* name = "lookup_table");
+
+protected:
+
+    void set_strides();
+
+    std::vector<std::vector<float> > categories;  // sorted values of each attribute
+    std::vector<size_t> strides;
+    std::vector<float> table;
+};
+
+#endif // ML_LOOKUP_TABLE_H
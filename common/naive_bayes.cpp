@@ -0,0 +1,255 @@
+// Library : Gaussian naive Bayes classifier (diagonal covariance)
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "naive_bayes.h"
+
+#include <algorithm>
+
+#include <float.h>
+#include <math.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/******************************************************************************/
+
+#define NAIVE_BAYES_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+// sum over the n attributes of (x - mean)^2 * weight
+
+static float weighted_distance(const float* x, const float* mean, const float* weight, int n)
+{
+    int j = 0;
+    float total = 0;
+
+#if defined(__SSE__)
+    __m128 sum = _mm_setzero_ps();
+    for (; j + 4 <= n; j += 4)
+    {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(x + j), _mm_loadu_ps(mean + j));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_mul_ps(d, d), _mm_loadu_ps(weight + j)));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+    for (; j < n; j++)
+    {
+        float d = x[j] - mean[j];
+        total += d * d * weight[j];
+    }
+
+    return total;
+}
+
+/******************************************************************************/
+
+GaussianNaiveBayes::GaussianNaiveBayes(double var_smoothing)
+    : smoothing(var_smoothing), n_dims(0)
+{
+}
+
+void GaussianNaiveBayes::train(const cv::Mat& data, const cv::Mat& responses)
+{
+    CV_Assert((data.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == data.rows) && (data.rows > 0));
+
+    cv::Mat r = responses.reshape(1, data.rows);
+    n_dims = data.cols;
+
+    // the distinct class labels, in increasing order
+
+    labels.clear();
+    for (int i = 0; i < data.rows; i++)
+    {
+        labels.push_back((float) cvRound(r.at<float>(i, 0)));
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    // class of each sample, and count of each class
+
+    std::vector<int> sample_class(data.rows);
+    std::vector<int> counts(classes(), 0);
+    for (int i = 0; i < data.rows; i++)
+    {
+        sample_class[i] = (int) (std::lower_bound(labels.begin(), labels.end(),
+                                 (float) cvRound(r.at<float>(i, 0))) - labels.begin());
+        counts[sample_class[i]]++;
+    }
+
+    // mean and variance of each attribute per class (two passes, in double)
+
+    cv::Mat sums = cv::Mat::zeros(classes(), n_dims, CV_64FC1);
+    cv::Mat squares = cv::Mat::zeros(classes(), n_dims, CV_64FC1);
+
+    for (int i = 0; i < data.rows; i++)
+    {
+        const float* x = data.ptr<float>(i);
+        double* s = sums.ptr<double>(sample_class[i]);
+        for (int j = 0; j < n_dims; j++)
+        {
+            s[j] += x[j];
+        }
+    }
+    for (int c = 0; c < classes(); c++)
+    {
+        sums.row(c) *= 1.0 / counts[c];
+    }
+    for (int i = 0; i < data.rows; i++)
+    {
+        const float* x = data.ptr<float>(i);
+        const double* m = sums.ptr<double>(sample_class[i]);
+        double* s = squares.ptr<double>(sample_class[i]);
+        for (int j = 0; j < n_dims; j++)
+        {
+            double d = x[j] - m[j];
+            s[j] += d * d;
+        }
+    }
+
+    // smoothing : a fraction of the largest variance of any attribute (over
+    // all of the samples)
+
+    double max_variance = 0;
+    for (int j = 0; j < n_dims; j++)
+    {
+        cv::Scalar mean, stddev;
+        cv::meanStdDev(data.col(j), mean, stddev);
+        max_variance = std::max(max_variance, stddev[0] * stddev[0]);
+    }
+    double epsilon = std::max(smoothing * max_variance, (double) FLT_MIN);
+
+    priors.resize(classes());
+    means.create(classes(), n_dims, CV_32FC1);
+    variances.create(classes(), n_dims, CV_32FC1);
+
+    for (int c = 0; c < classes(); c++)
+    {
+        priors[c] = (double) counts[c] / data.rows;
+        for (int j = 0; j < n_dims; j++)
+        {
+            means.at<float>(c, j) = (float) sums.at<double>(c, j);
+            variances.at<float>(c, j) = (float) (squares.at<double>(c, j) / counts[c] + epsilon);
+        }
+    }
+
+    set_scoring();
+}
+
+void GaussianNaiveBayes::set_scoring()
+{
+    inv_variances.create(classes(), n_dims, CV_32FC1);
+    constants.resize(classes());
+
+    for (int c = 0; c < classes(); c++)
+    {
+        double constant = log(priors[c]);
+        for (int j = 0; j < n_dims; j++)
+        {
+            double variance = variances.at<float>(c, j);
+            inv_variances.at<float>(c, j) = (float) (0.5 / variance);
+            constant -= 0.5 * log(2 * CV_PI * variance);
+        }
+        constants[c] = constant;
+    }
+}
+
+/******************************************************************************/
+
+float GaussianNaiveBayes::predict(const float* sample, double* log_likelihoods) const
+{
+    int best = 0;
+    double best_likelihood = -DBL_MAX;
+
+    for (int c = 0; c < classes(); c++)
+    {
+        double likelihood = constants[c] -
+                            weighted_distance(sample, means.ptr<float>(c),
+                                              inv_variances.ptr<float>(c), n_dims);
+        if (log_likelihoods)
+        {
+            log_likelihoods[c] = likelihood;
+        }
+        if (likelihood > best_likelihood)
+        {
+            best_likelihood = likelihood;
+            best = c;
+        }
+    }
+
+    return labels[best];
+}
+
+void GaussianNaiveBayes::predict(const cv::Mat& samples, cv::Mat& results, ThreadPool& pool) const
+{
+    CV_Assert((samples.type() == CV_32FC1) && (samples.cols == n_dims));
+
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+
+    pool.parallel_for(0, samples.rows, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            result.at<float>(i, 0) = predict(samples.ptr<float>(i));
+        }
+    }, NAIVE_BAYES_ROWS_PER_TASK);
+
+    results = result;
+}
+
+/******************************************************************************/
+
+void GaussianNaiveBayes::write(cv::FileStorage& fs, const char* name) const
+{
+    fs << name << "{"
+       << "var_smoothing" << smoothing
+       << "labels" << labels
+       << "priors" << priors
+       << "means" << means
+       << "variances" << variances
+       << "}";
+}
+
+bool GaussianNaiveBayes::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    node["var_smoothing"] >> smoothing;
+    node["labels"] >> labels;
+    node["priors"] >> priors;
+    node["means"] >> means;
+    node["variances"] >> variances;
+
+    if ((means.rows != classes()) || ((int) priors.size() != classes()) ||
+            (variances.rows != means.rows) || (variances.cols != means.cols))
+    {
+        // (not left half loaded)
+
+        labels.clear();
+        priors.clear();
+        constants.clear();
+        means.release();
+        variances.release();
+        inv_variances.release();
+        n_dims = 0;
+        return false;
+    }
+
+    n_dims = means.cols;
+    set_scoring();
+
+    return true;
+}
+
+/******************************************************************************/
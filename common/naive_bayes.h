@@ -0,0 +1,76 @@
+// Library : Gaussian naive Bayes classifier (diagonal covariance)
+
+// Each attribute is modelled by an independent normal distribution per class
+// - a mean and a variance, rather than the full covariance matrix of
+// CvNormalBayesClassifier (see normal_bayes.h) - so a sample is scored for a
+// class in O(d) as
+//     log prior - 1/2 sum log(2 pi var) - 1/2 sum (x - mean)^2 / var
+// the sum being vectorised (SSE, four attributes at a time) where available,
+// with a scalar fallback otherwise. As in [scikit-learn], a small fraction of
+// the largest attribute variance is added to every variance, so attributes
+// that never vary within a class do not give infinite log likelihoods.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_NAIVE_BAYES_H
+#define ML_NAIVE_BAYES_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class GaussianNaiveBayes
+{
+public:
+
+    explicit GaussianNaiveBayes(double var_smoothing = 1e-9);
+
+    // train from samples (rows of data, CV_32FC1) and their classes
+    // (responses, integer valued CV_32FC1)
+
+    void train(const cv::Mat& data, const cv::Mat& responses);
+
+    // class of one sample (dims values) - and, if given, the log likelihood
+    // (up to a constant) of each class into log_likelihoods
+
+    float predict(const float* sample, double* log_likelihoods = NULL) const;
+    float predict(const cv::Mat& sample) const { return predict(sample.ptr<float>(0)); }
+
+    // class of every row of samples (results, CV_32FC1 column), rows in
+    // parallel blocks on the pool
+
+    void predict(const cv::Mat& samples, cv::Mat& results,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    int classes() const { return (int) labels.size(); }
+    int dims() const { return n_dims; }
+    float label(int c) const { return labels[c]; }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "naive_bayes") const;
+    bool read(const cv::FileStorage& fs, const char* name = "naive_bayes");
+
+protected:
+
+    // precompute the per class constants from means and variances
+
+    void set_scoring();
+
+    double smoothing;
+    int n_dims;
+
+    std::vector<float> labels;      // class labels, in increasing order
+    std::vector<double> priors;     // proportion of the samples of each class
+    cv::Mat means;                  // classes x dims, CV_32FC1
+    cv::Mat variances;              // classes x dims, CV_32FC1 (smoothed)
+
+    cv::Mat inv_variances;          // 1 / (2 variance), classes x dims
+    std::vector<double> constants;  // log prior - 1/2 sum log(2 pi var)
+};
+
+#endif // ML_NAIVE_BAYES_H
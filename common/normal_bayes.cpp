@@ -0,0 +1,375 @@
+// Library : normal Bayes classifier with batch (whole matrix) prediction
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "normal_bayes.h"
+
+#include <algorithm>
+#include <map>
+
+#include <float.h>
+#include <math.h>
+
+/******************************************************************************/
+
+// fewest rows worth accumulating on a thread of their own
+
+#define NORMAL_BAYES_MIN_ROWS_PER_PART 512
+
+/******************************************************************************/
+
+void NormalBayesStats::clear()
+{
+    labels.clear();
+    counts.clear();
+    means.clear();
+    scatters.clear();
+}
+
+void NormalBayesStats::add(float label, int n, const cv::Mat& mean, const cv::Mat& scatter)
+{
+    int c = (int) (std::lower_bound(labels.begin(), labels.end(), label) - labels.begin());
+
+    if ((c == classes()) || (labels[c] != label))
+    {
+        labels.insert(labels.begin() + c, label);
+        counts.insert(counts.begin() + c, n);
+        means.insert(means.begin() + c, mean.clone());
+        scatters.insert(scatters.begin() + c, scatter.clone());
+        return;
+    }
+
+    // pairwise combination [Chan et al. 1979] : with delta the difference of
+    // the means, scatter = scatter_a + scatter_b + delta^T delta n_a n_b / n
+    // (new matrices rather than in place, as copies of these statistics
+    // share their matrix data)
+
+    double total = (double) counts[c] + n;
+    cv::Mat delta = mean - means[c];
+
+    scatters[c] = scatters[c] + scatter + delta.t() * delta * (counts[c] * (double) n / total);
+    means[c] = means[c] + delta * (n / total);
+    counts[c] += n;
+}
+
+void NormalBayesStats::update(const cv::Mat& data, const cv::Mat& responses, ThreadPool& pool)
+{
+    CV_Assert((data.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == data.rows));
+    CV_Assert(labels.empty() || (data.cols == means[0].cols));
+
+    cv::Mat r = responses.reshape(1, data.rows);
+
+    int parts = std::min(pool.thread_count(), data.rows / NORMAL_BAYES_MIN_ROWS_PER_PART);
+    if (parts <= 1)
+    {
+        accumulate(data, r);
+        return;
+    }
+
+    // one accumulator per part (contiguous rows), the parts in parallel, then
+    // reduced in part order - so the result does not depend on the scheduling
+
+    std::vector<NormalBayesStats> partial(parts);
+
+    pool.parallel_for(0, parts, [&](int begin, int end)
+    {
+        for (int p = begin; p < end; p++)
+        {
+            int first = (int) ((int64) data.rows * p / parts);
+            int last = (int) ((int64) data.rows * (p + 1) / parts);
+
+            partial[p].accumulate(data.rowRange(first, last), r.rowRange(first, last));
+        }
+    }, 1);
+
+    for (int p = 0; p < parts; p++)
+    {
+        merge(partial[p]);
+    }
+}
+
+void NormalBayesStats::accumulate(const cv::Mat& data, const cv::Mat& r)
+{
+    // the samples of the block grouped by class
+
+    std::map<float, cv::Mat> block;
+    for (int i = 0; i < data.rows; i++)
+    {
+        block[(float) cvRound(r.at<float>(i, 0))].push_back(data.row(i));
+    }
+
+    // the mean and scatter of each class within the block, folded in
+
+    for (std::map<float, cv::Mat>::const_iterator it = block.begin(); it != block.end(); ++it)
+    {
+        cv::Mat scatter, mean;
+        cv::calcCovarMatrix(it->second, scatter, mean,
+                            CV_COVAR_NORMAL | CV_COVAR_ROWS, CV_64F);
+
+        add(it->first, it->second.rows, mean, scatter);
+    }
+}
+
+void NormalBayesStats::merge(const NormalBayesStats& other)
+{
+    CV_Assert(labels.empty() || other.labels.empty() ||
+              (means[0].cols == other.means[0].cols));
+
+    for (int c = 0; c < other.classes(); c++)
+    {
+        add(other.labels[c], other.counts[c], other.means[c], other.scatters[c]);
+    }
+}
+
+void NormalBayesStats::get_class(int c, cv::Mat& mean, cv::Mat& covariance) const
+{
+    mean = means[c].clone();
+    covariance = scatters[c] * (1.0 / counts[c]);
+}
+
+void NormalBayesStats::write(cv::FileStorage& fs, const char* name) const
+{
+    // the classes stacked : means as rows, scatter matrices one below another
+
+    cv::Mat all_means, all_scatters;
+    for (int c = 0; c < classes(); c++)
+    {
+        all_means.push_back(means[c]);
+        all_scatters.push_back(scatters[c]);
+    }
+
+    fs << name << "{"
+       << "labels" << labels
+       << "counts" << counts
+       << "means" << all_means
+       << "scatters" << all_scatters
+       << "}";
+}
+
+bool NormalBayesStats::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    cv::Mat all_means, all_scatters;
+    node["labels"] >> labels;
+    node["counts"] >> counts;
+    node["means"] >> all_means;
+    node["scatters"] >> all_scatters;
+
+    int dims = all_means.cols;
+    if ((all_means.rows != classes()) || ((int) counts.size() != classes()) ||
+            (all_scatters.rows != classes() * dims))
+    {
+        clear();
+        return false;
+    }
+
+    means.resize(classes());
+    scatters.resize(classes());
+    for (int c = 0; c < classes(); c++)
+    {
+        means[c] = all_means.row(c).clone();
+        scatters[c] = all_scatters.rowRange(c * dims, (c + 1) * dims).clone();
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+void BatchNormalBayes::set_class(int c, const cv::Mat& mean, const cv::Mat& covariance)
+{
+    // covariance = E diag(lambda) E^T, so the whitening W = E diag(1 / sqrt(lambda))
+    // gives (x - mean) C^-1 (x - mean)^T = |(x - mean) W|^2
+
+    cv::Mat eigenvalues, eigenvectors;
+    cv::eigen(covariance, eigenvalues, eigenvectors);
+
+    int dims = covariance.rows;
+    cv::Mat w(dims, dims, CV_64FC1);
+    double log_det = 0;
+
+    for (int j = 0; j < dims; j++)
+    {
+        double lambda = std::max(eigenvalues.at<double>(j, 0), (double) FLT_EPSILON);
+        log_det += log(lambda);
+
+        // (eigenvectors are the rows of eigenvectors)
+
+        cv::Mat column = w.col(j);
+        cv::Mat vector = eigenvectors.row(j).t() * (1.0 / sqrt(lambda));
+        vector.copyTo(column);
+    }
+
+    means[c] = mean.clone();
+    whitening[c] = w;
+    offsets[c] = mean * w;
+    log_dets[c] = log_det;
+}
+
+void BatchNormalBayes::train(const cv::Mat& data, const cv::Mat& responses, ThreadPool& pool)
+{
+    stats.clear();
+    update(data, responses, pool);
+}
+
+void BatchNormalBayes::update(const cv::Mat& data, const cv::Mat& responses, ThreadPool& pool)
+{
+    stats.update(data, responses, pool);
+    train(stats, pool);
+}
+
+void BatchNormalBayes::train(const NormalBayesStats& statistics, ThreadPool& pool)
+{
+    if (&statistics != &stats)
+    {
+        stats = statistics;
+    }
+
+    labels.resize(stats.classes());
+    for (int c = 0; c < classes(); c++)
+    {
+        labels[c] = stats.label(c);
+    }
+
+    means.assign(labels.size(), cv::Mat());
+    whitening.assign(labels.size(), cv::Mat());
+    offsets.assign(labels.size(), cv::Mat());
+    log_dets.assign(labels.size(), 0.0);
+
+    // the whitening transform of each class from its mean and covariance -
+    // the classes in parallel
+
+    pool.parallel_for(0, classes(), [&](int begin, int end)
+    {
+        for (int c = begin; c < end; c++)
+        {
+            cv::Mat mean, covariance;
+            stats.get_class(c, mean, covariance);
+
+            set_class(c, mean, covariance);
+        }
+    }, 1);
+}
+
+/******************************************************************************/
+
+void BatchNormalBayes::predict(const cv::Mat& samples, cv::Mat& results, cv::Mat* scores,
+                               ThreadPool& pool) const
+{
+    CV_Assert(!labels.empty() && (samples.cols == means[0].cols));
+
+    cv::Mat x;
+    samples.convertTo(x, CV_64F);
+
+    cv::Mat score(samples.rows, classes(), CV_64FC1);
+
+    // score every sample for each class with one matrix product per class
+
+    pool.parallel_for(0, classes(), [&](int begin, int end)
+    {
+        for (int c = begin; c < end; c++)
+        {
+            cv::Mat y;
+            cv::gemm(x, whitening[c], 1, cv::Mat(), 0, y);
+
+            const double* offset = offsets[c].ptr<double>(0);
+            for (int i = 0; i < y.rows; i++)
+            {
+                const double* row = y.ptr<double>(i);
+                double distance = 0;
+                for (int j = 0; j < y.cols; j++)
+                {
+                    double d = row[j] - offset[j];
+                    distance += d * d;
+                }
+                score.at<double>(i, c) = log_dets[c] + distance;
+            }
+        }
+    }, 1);
+
+    // the most likely (smallest score) class of each sample
+
+    cv::Mat result(samples.rows, 1, CV_32FC1);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        const double* s = score.ptr<double>(i);
+        int best = (int) (std::min_element(s, s + classes()) - s);
+        result.at<float>(i, 0) = labels[best];
+    }
+
+    results = result;
+    if (scores)
+    {
+        *scores = score;
+    }
+}
+
+/******************************************************************************/
+
+void BatchNormalBayes::write(cv::FileStorage& fs, const char* name) const
+{
+    // the classes stacked : means as rows, whitening matrices one below another
+
+    cv::Mat all_means, all_whitening;
+    for (int c = 0; c < classes(); c++)
+    {
+        all_means.push_back(means[c]);
+        all_whitening.push_back(whitening[c]);
+    }
+
+    fs << name << "{"
+       << "labels" << labels
+       << "log_dets" << log_dets
+       << "means" << all_means
+       << "whitening" << all_whitening
+       << "}";
+}
+
+bool BatchNormalBayes::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    cv::Mat all_means, all_whitening;
+    node["labels"] >> labels;
+    node["log_dets"] >> log_dets;
+    node["means"] >> all_means;
+    node["whitening"] >> all_whitening;
+
+    int dims = all_means.cols;
+    if ((all_means.rows != classes()) || ((int) log_dets.size() != classes()) ||
+            (all_whitening.rows != classes() * dims))
+    {
+        // (not left half loaded)
+
+        labels.clear();
+        log_dets.clear();
+        means.clear();
+        whitening.clear();
+        offsets.clear();
+        return false;
+    }
+
+    means.resize(classes());
+    whitening.resize(classes());
+    offsets.resize(classes());
+    for (int c = 0; c < classes(); c++)
+    {
+        means[c] = all_means.row(c).clone();
+        whitening[c] = all_whitening.rowRange(c * dims, (c + 1) * dims).clone();
+        offsets[c] = means[c] * whitening[c];
+    }
+
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,146 @@
+// Library : normal Bayes classifier with batch (whole matrix) prediction
+
+// The same model as CvNormalBayesClassifier - a full covariance normal
+// distribution per class, the class chosen being the one with the smallest
+// log determinant plus Mahalanobis distance - but rather than evaluating the
+// Mahalanobis term for every class one sample at a time, each class's
+// whitening transform (eigenvectors scaled by 1 / sqrt(eigenvalue)) and log
+// determinant are computed once after training. The whole testing matrix is
+// then scored for each class with a single matrix product (whitened
+// distance = row norm of (X - mean) W), the classes in parallel on the pool.
+
+// Eigenvalues are clamped at FLT_EPSILON as by OpenCV, so attributes that
+// never vary within a class (e.g. the border pixels of optdigits), which make
+// the covariance singular, are handled - a Cholesky factorisation would fail.
+
+// The model can also be trained incrementally : NormalBayesStats holds the
+// sufficient statistics of each class (count, mean and scatter matrix - the
+// sum of outer products about the mean), into which further blocks of rows
+// are folded in O(block) time, and which can be merged with statistics
+// gathered separately (e.g. by other threads, on other parts of the data)
+// using the pairwise update of [Chan et al. 1979]. BatchNormalBayes keeps
+// its own statistics, so update() adds new data without revisiting the old.
+// Training itself is parallel in the same way : the rows are split between
+// the threads of the pool, each accumulating the scatter matrices of its
+// rows separately, and the partial statistics are then merged.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_NORMAL_BAYES_H
+#define ML_NORMAL_BAYES_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class NormalBayesStats
+{
+public:
+
+    void clear();
+
+    // fold in a block of samples (rows of data, CV_32FC1) and their classes
+    // (responses, integer valued CV_32FC1) - new classes are added as seen;
+    // large blocks are split into one part per thread of the pool, each
+    // accumulated into its own statistics and then merged (in order)
+
+    void update(const cv::Mat& data, const cv::Mat& responses,
+                ThreadPool& pool = ThreadPool::global());
+
+    // fold in the statistics of other (gathered from different samples)
+
+    void merge(const NormalBayesStats& other);
+
+    int classes() const { return (int) labels.size(); }
+    float label(int c) const { return labels[c]; }
+    int count(int c) const { return counts[c]; }
+
+    // mean (1 x dims) and covariance (normalised by the count, as by OpenCV;
+    // dims x dims) of class c, both CV_64FC1
+
+    void get_class(int c, cv::Mat& mean, cv::Mat& covariance) const;
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "normal_bayes_stats") const;
+    bool read(const cv::FileStorage& fs, const char* name = "normal_bayes_stats");
+
+protected:
+
+    // fold in a block of samples (on the calling thread)
+
+    void accumulate(const cv::Mat& data, const cv::Mat& responses);
+
+    // fold in n samples of class label with the given mean and scatter
+
+    void add(float label, int n, const cv::Mat& mean, const cv::Mat& scatter);
+
+    std::vector<float> labels;      // class labels, in increasing order
+    std::vector<int> counts;        // samples of each class
+    std::vector<cv::Mat> means;     // 1 x dims, CV_64FC1
+    std::vector<cv::Mat> scatters;  // dims x dims, CV_64FC1
+};
+
+/******************************************************************************/
+
+class BatchNormalBayes
+{
+public:
+
+    // train from samples (rows of data, CV_32FC1) and their classes
+    // (responses, integer valued CV_32FC1)
+
+    void train(const cv::Mat& data, const cv::Mat& responses,
+               ThreadPool& pool = ThreadPool::global());
+
+    // train from previously gathered statistics
+
+    void train(const NormalBayesStats& statistics,
+               ThreadPool& pool = ThreadPool::global());
+
+    // add further samples to those already trained on (as by train(), the
+    // model is then recomputed from the updated statistics)
+
+    void update(const cv::Mat& data, const cv::Mat& responses,
+                ThreadPool& pool = ThreadPool::global());
+
+    // (the statistics are not stored by write() - to continue training a
+    // model later, write them as well)
+
+    const NormalBayesStats& statistics() const { return stats; }
+
+    // class of every row of samples (results, CV_32FC1 column) and, if
+    // scores is given, the score of each row for each class (smaller is
+    // more likely, samples.rows x classes(), CV_64FC1)
+
+    void predict(const cv::Mat& samples, cv::Mat& results, cv::Mat* scores = NULL,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    int classes() const { return (int) labels.size(); }
+    float label(int c) const { return labels[c]; }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "normal_bayes") const;
+    bool read(const cv::FileStorage& fs, const char* name = "normal_bayes");
+
+protected:
+
+    // set class c from its mean (1 x dims) and covariance (dims x dims)
+
+    void set_class(int c, const cv::Mat& mean, const cv::Mat& covariance);
+
+    std::vector<float> labels;      // class labels, in increasing order
+    std::vector<cv::Mat> means;     // 1 x dims, CV_64FC1
+    std::vector<cv::Mat> whitening; // dims x dims, CV_64FC1
+    std::vector<cv::Mat> offsets;   // mean * whitening, 1 x dims
+    std::vector<double> log_dets;   // log determinant of each covariance
+
+    NormalBayesStats stats;         // of all the samples trained on
+};
+
+#endif // ML_NORMAL_BAYES_H
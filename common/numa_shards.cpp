@@ -0,0 +1,248 @@
+// Library : NUMA aware placement of data for parallel training and search
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "numa_shards.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+/******************************************************************************/
+
+// adds the CPUs in a Linux cpulist string (e.g. "0-3,8-11") to the table
+
+static void parse_cpulist(const char* list, int node, std::vector<int>& table)
+{
+    const char* p = list;
+    while (*p)
+    {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p)
+        {
+            break;
+        }
+
+        long last = first;
+        if (*end == '-')
+        {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if ((size_t) cpu >= table.size())
+            {
+                table.resize(cpu + 1, 0);
+            }
+            table[cpu] = node;
+        }
+
+        if (*end != ',')
+        {
+            break;
+        }
+        p = end + 1;
+    }
+}
+
+// CPU -> NUMA node lookup table (built once)
+
+static const std::vector<int>& cpu_node_table()
+{
+    static std::vector<int> table;
+    static std::once_flag built;
+
+    std::call_once(built, []()
+    {
+#ifdef HAVE_LIBNUMA
+        if (numa_available() >= 0)
+        {
+            table.resize(numa_num_configured_cpus(), 0);
+            for (size_t cpu = 0; cpu < table.size(); cpu++)
+            {
+                table[cpu] = std::max(0, numa_node_of_cpu((int) cpu));
+            }
+            return;
+        }
+#endif
+        // otherwise ask sysfs (Linux), anywhere else everything is node 0
+
+        char path[64];
+        char list[4096];
+        for (int node = 0; node < 256; node++)
+        {
+            sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+            FILE* f = fopen(path, "r");
+            if (!f)
+            {
+                continue;
+            }
+            if (fgets(list, sizeof(list), f))
+            {
+                parse_cpulist(list, node, table);
+            }
+            fclose(f);
+        }
+    });
+
+    return table;
+}
+
+int numa_nodes()
+{
+    const std::vector<int>& table = cpu_node_table();
+    int max_node = 0;
+    for (size_t cpu = 0; cpu < table.size(); cpu++)
+    {
+        max_node = std::max(max_node, table[cpu]);
+    }
+    return max_node + 1;
+}
+
+int cpu_numa_node(int cpu)
+{
+    const std::vector<int>& table = cpu_node_table();
+    return ((cpu >= 0) && ((size_t) cpu < table.size())) ? table[cpu] : 0;
+}
+
+int thread_numa_node(const ThreadPool& pool, int index)
+{
+    int cpu = pool.thread_cpu(index);
+    return (cpu >= 0) ? cpu_numa_node(cpu) : -1;
+}
+
+/******************************************************************************/
+
+// a matrix to be filled (first touched) by the calling thread - with libnuma
+// its memory is explicitly placed on the given node and released through
+// owner, otherwise it is an ordinary matrix and the first touch places it
+
+static cv::Mat allocate_on_node(int rows, int cols, int type, int node,
+                                std::shared_ptr<void>& owner)
+{
+#ifdef HAVE_LIBNUMA
+    size_t bytes = (size_t) rows * cols * CV_ELEM_SIZE(type);
+    if ((node >= 0) && (bytes > 0) && (numa_available() >= 0))
+    {
+        void* p = numa_alloc_onnode(bytes, node);
+        if (p)
+        {
+            owner = std::shared_ptr<void>(p, [bytes](void* q) { numa_free(q, bytes); });
+            return cv::Mat(rows, cols, type, p);
+        }
+    }
+#else
+    (void) node;
+    (void) owner;
+#endif
+
+    return cv::Mat(rows, cols, type);
+}
+
+// threads that own data : the workers, or thread 0 if there are none
+// (thread 0 is whichever thread is waiting, so is not tied to any node)
+
+static int first_owner_thread(const ThreadPool& pool)
+{
+    return (pool.thread_count() > 1) ? 1 : 0;
+}
+
+/******************************************************************************/
+
+void RowShards::partition(const cv::Mat& src, ThreadPool& pool)
+{
+    int first = first_owner_thread(pool);
+    int n = std::max(1, std::min(pool.thread_count() - first, src.rows));
+
+    shards.assign(n, cv::Mat());
+    offsets.assign(n + 1, 0);
+    threads.assign(n, 0);
+    nodes.assign(n, -1);
+    memory.assign(n, std::shared_ptr<void>());
+
+    for (int i = 0; i <= n; i++)
+    {
+        offsets[i] = (int) (((long) src.rows * i) / n);
+    }
+
+    // each shard is allocated and copied by the thread that owns it
+
+    TaskGroup group(pool);
+    for (int i = 0; i < n; i++)
+    {
+        threads[i] = first + i;
+        nodes[i] = thread_numa_node(pool, threads[i]);
+
+        group.run_on(threads[i], [this, &src, i]()
+        {
+            cv::Mat local = allocate_on_node(offsets[i + 1] - offsets[i], src.cols,
+                                             src.type(), nodes[i], memory[i]);
+            src.rowRange(offsets[i], offsets[i + 1]).copyTo(local);
+            shards[i] = local;
+        });
+    }
+    group.wait();
+
+    offsets.pop_back();
+}
+
+/******************************************************************************/
+
+void NodeReplicas::replicate(const cv::Mat& src, ThreadPool& pool)
+{
+    int first = first_owner_thread(pool);
+    std::vector<int> owners;
+
+    // one replica per distinct node, made by the first thread on that node
+    // (unpinned threads all count as node -1 and so share one replica)
+
+    nodes.clear();
+    replica_of_thread.assign(pool.thread_count(), 0);
+    for (int t = first; t < pool.thread_count(); t++)
+    {
+        int node = thread_numa_node(pool, t);
+        size_t r = std::find(nodes.begin(), nodes.end(), node) - nodes.begin();
+        if (r == nodes.size())
+        {
+            nodes.push_back(node);
+            owners.push_back(t);
+        }
+        replica_of_thread[t] = (int) r;
+    }
+
+    replicas.assign(nodes.size(), cv::Mat());
+    memory.assign(nodes.size(), std::shared_ptr<void>());
+
+    TaskGroup group(pool);
+    for (size_t r = 0; r < nodes.size(); r++)
+    {
+        group.run_on(owners[r], [this, &src, r]()
+        {
+            cv::Mat local = allocate_on_node(src.rows, src.cols, src.type(),
+                                             nodes[r], memory[r]);
+            src.copyTo(local);
+            replicas[r] = local;
+        });
+    }
+    group.wait();
+}
+
+const cv::Mat& NodeReplicas::for_thread(int index) const
+{
+    if ((index < 0) || ((size_t) index >= replica_of_thread.size()))
+    {
+        index = 0;
+    }
+    return replicas[replica_of_thread[index]];
+}
+
+/******************************************************************************/
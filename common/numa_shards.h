@@ -0,0 +1,94 @@
+// Library : NUMA aware placement of data for parallel training and search
+
+// A matrix loaded by one thread has all of its pages on that thread's NUMA
+// node, so on a multi-socket machine every other socket reads it remotely.
+// Here the data is instead copied into shards (or whole replicas) that are
+// allocated and filled by the pool thread that will later use them - with
+// libnuma (HAVE_LIBNUMA) the memory is explicitly allocated on that thread's
+// node, otherwise the kernel's first-touch policy puts it there.
+
+// Only meaningful when the pool threads are pinned (ThreadPool(n, true) or
+// ML_PIN_THREADS=1) - unpinned, the shards are still valid but may drift.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_NUMA_SHARDS_H
+#define ML_NUMA_SHARDS_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <memory>
+#include <vector>
+
+/******************************************************************************/
+
+// number of NUMA nodes on this machine (1 if unknown or not NUMA)
+
+int numa_nodes();
+
+// NUMA node a CPU belongs to (0 if unknown)
+
+int cpu_numa_node(int cpu);
+
+// NUMA node that thread index of a pool runs on (-1 if the thread is not
+// pinned, so could be on any node)
+
+int thread_numa_node(const ThreadPool& pool, int index);
+
+/******************************************************************************/
+
+// the rows of a matrix split into one contiguous shard per pool thread,
+// each shard placed on the NUMA node of the thread that owns it - tasks that
+// read shard i should be run with TaskGroup::run_on(shards.thread(i), ...)
+
+class RowShards
+{
+public:
+
+    void partition(const cv::Mat& src, ThreadPool& pool = ThreadPool::global());
+
+    int count() const { return (int) shards.size(); }
+
+    const cv::Mat& rows(int i) const { return shards[i]; }
+    int first_row(int i) const { return offsets[i]; }  // index of rows(i).row(0) in src
+    int thread(int i) const { return threads[i]; }     // pool thread that owns the shard
+    int node(int i) const { return nodes[i]; }         // NUMA node it is on (-1 unknown)
+
+private:
+
+    std::vector<cv::Mat> shards;
+    std::vector<int> offsets;
+    std::vector<int> threads;
+    std::vector<int> nodes;
+    std::vector< std::shared_ptr<void> > memory;
+};
+
+/******************************************************************************/
+
+// one complete copy of a matrix per NUMA node used by the pool threads, for
+// work where every thread needs to read all of the data (e.g. each thread
+// training some of the trees of a forest)
+
+class NodeReplicas
+{
+public:
+
+    void replicate(const cv::Mat& src, ThreadPool& pool = ThreadPool::global());
+
+    int count() const { return (int) replicas.size(); }
+
+    // the copy closest to (i.e. on the same node as) thread index of the pool
+
+    const cv::Mat& for_thread(int index) const;
+
+private:
+
+    std::vector<cv::Mat> replicas;
+    std::vector<int> nodes;              // node each replica is on
+    std::vector<int> replica_of_thread;  // pool thread index -> replica
+    std::vector< std::shared_ptr<void> > memory;
+};
+
+#endif // ML_NUMA_SHARDS_H
@@ -0,0 +1,200 @@
+// Library : PCA dimensionality reduction as a preprocessing stage
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "pca_stage.h"
+
+#include "opencv2/core/core_c.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+
+#define RANDOMIZED_OVERSAMPLING 10     // extra random directions sampled
+#define RANDOMIZED_POWER_ITERATIONS 2  // sharpen the range (noisy spectra)
+#define RANDOMIZED_SEED 0x12345678
+
+#define TRANSFORM_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+// sum of the variances of all of the attributes of data about mean (scaled
+// by 1 / number of samples as the cv::PCA eigenvalues are)
+
+static double total_variance_of(const cv::Mat& data, const cv::Mat& mean)
+{
+    cv::Mat centred = data - cv::repeat(mean, data.rows, 1);
+    double sum_squares = cv::norm(centred, cv::NORM_L2);
+    return (sum_squares * sum_squares) / data.rows;
+}
+
+// orthonormal basis for the column space of m
+
+static cv::Mat orthonormalize(const cv::Mat& m)
+{
+    cv::Mat w, u, vt;
+    cv::SVD::compute(m, w, u, vt);
+    return u;
+}
+
+/******************************************************************************/
+
+PCAStage::PCAStage() : total_variance(0)
+{
+}
+
+void PCAStage::fit(const cv::Mat& data, int n_components, Method method)
+{
+    n_components = std::max(1, std::min(n_components, std::min(data.rows, data.cols)));
+
+    if (method == EXACT)
+    {
+        cv::PCA pca(data, cv::Mat(), CV_PCA_DATA_AS_ROW, n_components);
+        mean = pca.mean;
+        eigenvectors = pca.eigenvectors;
+        eigenvalues = pca.eigenvalues;
+        total_variance = total_variance_of(data, mean);
+        return;
+    }
+
+    // randomized SVD (Halko, Martinsson & Tropp, 2011) of the centred data X :
+    // find an orthonormal Q whose columns span (approximately) the range of X
+    // from X applied to a few random vectors, then the components are the
+    // right singular vectors of the much smaller matrix Q^T X
+
+    cv::Mat x;
+    data.convertTo(x, CV_64F);
+
+    cv::Mat mean64;
+    cv::reduce(x, mean64, 0, CV_REDUCE_AVG);
+    x -= cv::repeat(mean64, x.rows, 1);
+
+    int l = std::min(n_components + RANDOMIZED_OVERSAMPLING, std::min(x.rows, x.cols));
+
+    cv::Mat omega(x.cols, l, CV_64F);
+    cv::RNG rng(RANDOMIZED_SEED);
+    rng.fill(omega, cv::RNG::NORMAL, cv::Scalar(0), cv::Scalar(1));
+
+    cv::Mat y, z;
+    cv::gemm(x, omega, 1, cv::Mat(), 0, y);
+    for (int i = 0; i < RANDOMIZED_POWER_ITERATIONS; i++)
+    {
+        cv::gemm(x, orthonormalize(y), 1, cv::Mat(), 0, z, cv::GEMM_1_T);
+        cv::gemm(x, orthonormalize(z), 1, cv::Mat(), 0, y);
+    }
+
+    cv::Mat b;
+    cv::gemm(orthonormalize(y), x, 1, cv::Mat(), 0, b, cv::GEMM_1_T);
+
+    cv::Mat w, u, vt;
+    cv::SVD::compute(b, w, u, vt);
+
+    // singular value s of X <=> eigenvalue s^2 / n of its covariance matrix
+
+    cv::Mat values = w.rowRange(0, n_components).mul(w.rowRange(0, n_components)) / x.rows;
+
+    mean64.convertTo(mean, data.type());
+    vt.rowRange(0, n_components).convertTo(eigenvectors, data.type());
+    values.convertTo(eigenvalues, data.type());
+    total_variance = total_variance_of(data, mean);
+}
+
+void PCAStage::fit_variance(const cv::Mat& data, double retained)
+{
+    fit(data, std::min(data.rows, data.cols), EXACT);
+
+    // keep the leading components up to the required share of the variance
+
+    double kept = 0;
+    int n = 0;
+    while ((n < eigenvalues.rows) && (kept < retained * total_variance))
+    {
+        kept += eigenvalues.at<float>(n, 0);
+        n++;
+    }
+    n = std::max(1, n);
+
+    eigenvectors = eigenvectors.rowRange(0, n).clone();
+    eigenvalues = eigenvalues.rowRange(0, n).clone();
+}
+
+/******************************************************************************/
+
+void PCAStage::transform(const cv::Mat& data, cv::Mat& projected, ThreadPool& pool) const
+{
+    CV_Assert(!empty() && (data.cols == input_dims()) && (data.type() == mean.type()));
+
+    // (a new matrix, so that data and projected may be the same object)
+
+    cv::Mat result(data.rows, components(), data.type());
+
+    // (x - mean) * eigenvectors^T, for a block of rows at a time
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        cv::Mat centred = data.rowRange(begin, end) - cv::repeat(mean, end - begin, 1);
+        cv::Mat out = result.rowRange(begin, end);
+        cv::gemm(centred, eigenvectors, 1, cv::Mat(), 0, out, cv::GEMM_2_T);
+    }, TRANSFORM_ROWS_PER_TASK);
+
+    projected = result;
+}
+
+cv::Mat PCAStage::transform(const cv::Mat& data) const
+{
+    cv::Mat projected;
+    transform(data, projected);
+    return projected;
+}
+
+double PCAStage::retained_variance() const
+{
+    return (total_variance > 0) ? (cv::sum(eigenvalues)[0] / total_variance) : 0;
+}
+
+/******************************************************************************/
+
+void PCAStage::write(cv::FileStorage& fs, const char* name) const
+{
+    fs << name << "{"
+       << "mean" << mean
+       << "eigenvectors" << eigenvectors
+       << "eigenvalues" << eigenvalues
+       << "total_variance" << total_variance
+       << "}";
+}
+
+bool PCAStage::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    node["mean"] >> mean;
+    node["eigenvectors"] >> eigenvectors;
+    node["eigenvalues"] >> eigenvalues;
+    node["total_variance"] >> total_variance;
+
+    return !empty() && (mean.cols == eigenvectors.cols);
+}
+
+bool PCAStage::save(const char* filename) const
+{
+    cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+    if (!fs.isOpened())
+    {
+        return false;
+    }
+    write(fs);
+    return true;
+}
+
+bool PCAStage::load(const char* filename)
+{
+    cv::FileStorage fs(filename, cv::FileStorage::READ);
+    return fs.isOpened() && read(fs);
+}
+
+/******************************************************************************/
@@ -0,0 +1,78 @@
+// Library : PCA dimensionality reduction as a preprocessing stage
+
+// The projection is fitted to the training samples (one per row) and then
+// applied, in batch, to both the training and the testing samples before
+// they reach the classifier - for data with many (correlated) attributes,
+// such as isolet's 617, far fewer projected attributes make kernel
+// evaluations, distances and split searches correspondingly cheaper.
+
+// The projection can be found exactly (eigen decomposition of the covariance
+// matrix, via cv::PCA) or approximately by randomized SVD (cheaper when only
+// a few components are wanted from a lot of attributes). It is written to /
+// read from an OpenCV FileStorage so it can be kept with the trained model.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_PCA_STAGE_H
+#define ML_PCA_STAGE_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+/******************************************************************************/
+
+class PCAStage
+{
+public:
+
+    enum Method
+    {
+        EXACT = 0,      // all eigenvectors of the covariance matrix (cv::PCA)
+        RANDOMIZED = 1  // randomized SVD (approximate leading components only)
+    };
+
+    PCAStage();
+
+    // fit to data (samples as rows, CV_32FC1) keeping n_components
+
+    void fit(const cv::Mat& data, int n_components, Method method = EXACT);
+
+    // fit to data keeping the fewest components that retain at least the
+    // given fraction (0 - 1) of the total variance (exact method)
+
+    void fit_variance(const cv::Mat& data, double retained);
+
+    // project every row of data (n x input_dims) giving n x components() -
+    // rows are projected in parallel blocks on the pool
+
+    void transform(const cv::Mat& data, cv::Mat& projected,
+                   ThreadPool& pool = ThreadPool::global()) const;
+
+    cv::Mat transform(const cv::Mat& data) const;
+
+    bool empty() const { return eigenvectors.empty(); }
+    int components() const { return eigenvectors.rows; }
+    int input_dims() const { return eigenvectors.cols; }
+
+    // fraction of the total variance of the training data that is retained
+
+    double retained_variance() const;
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "pca_stage") const;
+    bool read(const cv::FileStorage& fs, const char* name = "pca_stage");
+
+    bool save(const char* filename) const;
+    bool load(const char* filename);
+
+private:
+
+    cv::Mat mean;           // 1 x input_dims
+    cv::Mat eigenvectors;   // components x input_dims (one per row, leading first)
+    cv::Mat eigenvalues;    // components x 1 (variance along each component)
+    double total_variance;  // sum of the variances of all of the input attributes
+};
+
+#endif // ML_PCA_STAGE_H
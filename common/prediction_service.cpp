@@ -0,0 +1,176 @@
+// Library : prediction serving with admission control and backpressure
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "prediction_service.h"
+
+#include <algorithm>
+#include <exception>
+
+/******************************************************************************/
+
+PredictionService::PredictionService(const Predictor& p, int queue_capacity,
+                                     OverloadPolicy overload_policy, int n_servers)
+    : predictor(p), capacity(std::max(1, queue_capacity)), policy(overload_policy),
+      stopping(false), peak_depth(0), n_accepted(0), n_rejected(0),
+      n_completed(0), total_wait_ms(0), max_wait_ms(0)
+{
+    for (int i = 0; i < std::max(1, n_servers); i++)
+    {
+        servers.push_back(std::thread(&PredictionService::serve, this));
+    }
+}
+
+PredictionService::~PredictionService()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    not_empty.notify_all();
+    not_full.notify_all();
+
+    for (size_t i = 0; i < servers.size(); i++)
+    {
+        servers[i].join();
+    }
+}
+
+/******************************************************************************/
+
+bool PredictionService::submit(const cv::Mat& sample, std::future<float>& result)
+{
+    Request* request = new Request;
+    request->sample = sample.clone();
+    result = request->result.get_future();
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    if ((int) queue.size() >= capacity)
+    {
+        if (policy == SHED)
+        {
+            n_rejected++;
+            guard.unlock();
+
+            delete request;
+            result = std::future<float>();
+            return false;
+        }
+
+        // BLOCK : wait for a server thread to take a request off the queue
+
+        not_full.wait(guard, [this]() { return stopping || ((int) queue.size() < capacity); });
+    }
+
+    if (stopping)
+    {
+        n_rejected++;
+        guard.unlock();
+
+        delete request;
+        result = std::future<float>();
+        return false;
+    }
+
+    request->enqueued = Clock::now();
+    queue.push_back(request);
+    n_accepted++;
+    peak_depth = std::max(peak_depth, (int) queue.size());
+
+    guard.unlock();
+    not_empty.notify_one();
+
+    return true;
+}
+
+/******************************************************************************/
+
+void PredictionService::serve()
+{
+    for (;;)
+    {
+        Request* request;
+        double wait_ms;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            not_empty.wait(guard, [this]() { return stopping || !queue.empty(); });
+
+            // on shutdown, finish off whatever was already accepted
+
+            if (queue.empty())
+            {
+                return;
+            }
+
+            request = queue.front();
+            queue.pop_front();
+
+            wait_ms = std::chrono::duration<double, std::milli>(
+                          Clock::now() - request->enqueued).count();
+        }
+        not_full.notify_one();
+
+        float value = 0;
+        std::exception_ptr error;
+        try
+        {
+            value = predictor(request->sample);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // count the request as completed before the caller can see the result
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            n_completed++;
+            total_wait_ms += wait_ms;
+            max_wait_ms = std::max(max_wait_ms, wait_ms);
+        }
+
+        if (error)
+        {
+            request->result.set_exception(error);
+        }
+        else
+        {
+            request->result.set_value(value);
+        }
+        delete request;
+    }
+}
+
+/******************************************************************************/
+
+PredictionServiceStats PredictionService::stats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    PredictionServiceStats s;
+    s.queue_depth = (int) queue.size();
+    s.peak_queue_depth = peak_depth;
+    s.accepted = n_accepted;
+    s.rejected = n_rejected;
+    s.completed = n_completed;
+    s.mean_wait_ms = n_completed ? (total_wait_ms / n_completed) : 0;
+    s.max_wait_ms = max_wait_ms;
+    return s;
+}
+
+int PredictionService::queue_depth() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return (int) queue.size();
+}
+
+long PredictionService::rejected_count() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return n_rejected;
+}
+
+/******************************************************************************/
@@ -0,0 +1,115 @@
+// Library : prediction serving with admission control and backpressure
+
+// Requests (one sample each) are queued for a fixed set of server threads
+// that run the classifier. The queue is bounded - once it holds
+// queue_capacity requests, further requests are either rejected straight
+// away (SHED) or the caller waits until there is room (BLOCK), so that a
+// burst of requests can never build an unbounded backlog (and latency).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_PREDICTION_SERVICE_H
+#define ML_PREDICTION_SERVICE_H
+
+#include "opencv2/core/core.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/******************************************************************************/
+
+// counters describing the state of a prediction service
+
+struct PredictionServiceStats
+{
+    int queue_depth;        // requests currently waiting
+    int peak_queue_depth;   // most requests ever waiting at once
+    long accepted;          // requests admitted to the queue
+    long rejected;          // requests shed because the queue was full
+    long completed;         // requests that have been answered
+    double mean_wait_ms;    // mean time spent queued (completed requests)
+    double max_wait_ms;     // longest time spent queued
+};
+
+/******************************************************************************/
+
+class PredictionService
+{
+public:
+
+    // what to do with a request that arrives when the queue is full
+
+    enum OverloadPolicy
+    {
+        SHED = 0,   // reject it immediately
+        BLOCK = 1   // make the caller wait until there is room
+    };
+
+    // classifier used to answer a request (called concurrently by all of
+    // the server threads, so it must be safe to call from several threads)
+
+    typedef std::function<float (const cv::Mat& sample)> Predictor;
+
+    PredictionService(const Predictor& predictor, int queue_capacity,
+                      OverloadPolicy policy = SHED, int n_servers = 1);
+
+    // answers everything already accepted then stops the server threads
+
+    ~PredictionService();
+
+    // submit one sample (which is copied) for prediction - returns false if
+    // the request was shed, otherwise result will become ready once a server
+    // thread has run the classifier on it
+
+    bool submit(const cv::Mat& sample, std::future<float>& result);
+
+    PredictionServiceStats stats() const;
+
+    int queue_depth() const;
+    long rejected_count() const;
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request
+    {
+        cv::Mat sample;
+        std::promise<float> result;
+        Clock::time_point enqueued;
+    };
+
+    PredictionService(const PredictionService&);
+    PredictionService& operator=(const PredictionService&);
+
+    void serve();
+
+    Predictor predictor;
+    int capacity;
+    OverloadPolicy policy;
+
+    mutable std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<Request*> queue;
+    bool stopping;
+
+    std::vector<std::thread> servers;
+
+    // counters (protected by lock)
+
+    int peak_depth;
+    long n_accepted;
+    long n_rejected;
+    long n_completed;
+    double total_wait_ms;
+    double max_wait_ms;
+};
+
+#endif // ML_PREDICTION_SERVICE_H
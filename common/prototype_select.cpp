@@ -0,0 +1,306 @@
+// Library : training set reduction for nearest neighbour classification
+// (edited and condensed nearest neighbour)
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "prototype_select.h"
+
+#include "opencv2/ml/ml.hpp"
+
+#include <algorithm>
+
+#include <float.h>
+#include <math.h>
+
+/******************************************************************************/
+
+PrototypeSelector::PrototypeSelector()
+    : n_rows(0), chosen(PROTOTYPES_ALL)
+{
+    std::fill(accuracies, accuracies + PROTOTYPES_METHODS, -1.0);
+}
+
+void PrototypeSelector::reset(int rows)
+{
+    n_rows = rows;
+    kept.resize(rows);
+    for (int i = 0; i < rows; i++)
+    {
+        kept[i] = i;
+    }
+    chosen = PROTOTYPES_ALL;
+}
+
+/******************************************************************************/
+
+void PrototypeSelector::edit(const cv::Mat& data, const cv::Mat& responses, int k)
+{
+    CV_Assert((data.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == data.rows) && (k > 0));
+
+    if (n_rows != data.rows)
+    {
+        reset(data.rows);
+    }
+    if ((int) kept.size() <= k)
+    {
+        return;
+    }
+
+    cv::Mat samples, classes;
+    transform(data, responses, samples, classes);
+
+    // the k + 1 nearest of each kept sample - one of which is itself
+
+    CvKNearest knn;
+    knn.train(samples, classes, cv::Mat(), false, k + 1);
+
+    cv::Mat results, neighbour_responses, distances;
+    knn.find_nearest(samples, k + 1, results, neighbour_responses, distances);
+
+    std::vector<int> edited;
+    for (int i = 0; i < samples.rows; i++)
+    {
+        const float* neighbours = neighbour_responses.ptr<float>(i);
+        const float* d = distances.ptr<float>(i);
+        float label = classes.at<float>(i, 0);
+
+        // leave out (one occurrence of) the sample itself
+
+        int self = -1;
+        for (int j = 0; (j <= k) && (self < 0); j++)
+        {
+            if ((d[j] == 0) && (neighbours[j] == label))
+            {
+                self = j;
+            }
+        }
+        if (self < 0)
+        {
+            self = k;
+        }
+
+        // kept if no other class has more votes than its own
+
+        int own_votes = 0;
+        int best_other = 0;
+        for (int j = 0; j <= k; j++)
+        {
+            if (j == self)
+            {
+                continue;
+            }
+
+            int votes = 0;
+            for (int l = 0; l <= k; l++)
+            {
+                votes += (l != self) && (neighbours[l] == neighbours[j]);
+            }
+
+            if (neighbours[j] == label)
+            {
+                own_votes = votes;
+            }
+            else
+            {
+                best_other = std::max(best_other, votes);
+            }
+        }
+
+        if (own_votes >= best_other)
+        {
+            edited.push_back(kept[i]);
+        }
+    }
+
+    kept.swap(edited);
+}
+
+/******************************************************************************/
+
+void PrototypeSelector::condense(const cv::Mat& data, const cv::Mat& responses)
+{
+    CV_Assert((data.type() == CV_32FC1) && (responses.type() == CV_32FC1) &&
+              ((int) responses.total() == data.rows));
+
+    if (n_rows != data.rows)
+    {
+        reset(data.rows);
+    }
+
+    cv::Mat r = responses.reshape(1, data.rows);
+    const int dims = data.cols;
+
+    // start from the first sample of each class
+
+    std::vector<int> store;
+    std::vector<float> seen;
+    std::vector<bool> stored(data.rows, false);
+
+    for (size_t i = 0; i < kept.size(); i++)
+    {
+        float label = r.at<float>(kept[i], 0);
+        if (std::find(seen.begin(), seen.end(), label) == seen.end())
+        {
+            seen.push_back(label);
+            store.push_back(kept[i]);
+            stored[kept[i]] = true;
+        }
+    }
+
+    // add each sample that the store misclassifies by its nearest neighbour,
+    // passing over the samples until none is added
+
+    bool added = true;
+    while (added)
+    {
+        added = false;
+        for (size_t i = 0; i < kept.size(); i++)
+        {
+            int row = kept[i];
+            if (stored[row])
+            {
+                continue;
+            }
+
+            const float* x = data.ptr<float>(row);
+            int nearest = store[0];
+            float nearest_distance = FLT_MAX;
+
+            for (size_t s = 0; s < store.size(); s++)
+            {
+                // (abandoning the distance once it exceeds the nearest so far)
+
+                const float* y = data.ptr<float>(store[s]);
+                float distance = 0;
+                for (int j = 0; (j < dims) && (distance < nearest_distance); j++)
+                {
+                    float d = x[j] - y[j];
+                    distance += d * d;
+                }
+                if (distance < nearest_distance)
+                {
+                    nearest_distance = distance;
+                    nearest = store[s];
+                }
+            }
+
+            if (r.at<float>(nearest, 0) != r.at<float>(row, 0))
+            {
+                store.push_back(row);
+                stored[row] = true;
+                added = true;
+            }
+        }
+    }
+
+    std::sort(store.begin(), store.end());
+    kept.swap(store);
+}
+
+/******************************************************************************/
+
+void PrototypeSelector::apply(int method, const cv::Mat& data, const cv::Mat& responses,
+                              int edit_k)
+{
+    reset(data.rows);
+
+    if ((method == PROTOTYPES_EDITED) || (method == PROTOTYPES_EDITED_CONDENSED))
+    {
+        edit(data, responses, edit_k);
+    }
+    if ((method == PROTOTYPES_CONDENSED) || (method == PROTOTYPES_EDITED_CONDENSED))
+    {
+        condense(data, responses);
+    }
+
+    chosen = method;
+}
+
+int PrototypeSelector::select(const cv::Mat& data, const cv::Mat& responses,
+                              const cv::Mat& validation_data, const cv::Mat& validation_responses,
+                              int k, double tolerance, int edit_k)
+{
+    std::fill(accuracies, accuracies + PROTOTYPES_METHODS, -1.0);
+
+    accuracies[PROTOTYPES_ALL] = accuracy(data, responses, validation_data,
+                                          validation_responses, k);
+
+    for (int method = PROTOTYPES_METHODS - 1; method > PROTOTYPES_ALL; method--)
+    {
+        apply(method, data, responses, edit_k);
+
+        cv::Mat kept_data, kept_responses;
+        transform(data, responses, kept_data, kept_responses);
+
+        accuracies[method] = accuracy(kept_data, kept_responses, validation_data,
+                                      validation_responses, k);
+
+        if (accuracies[PROTOTYPES_ALL] - accuracies[method] <= tolerance)
+        {
+            return chosen;
+        }
+    }
+
+    reset(data.rows);
+    return chosen;
+}
+
+/******************************************************************************/
+
+void PrototypeSelector::transform(const cv::Mat& data, const cv::Mat& responses,
+                                  cv::Mat& kept_data, cv::Mat& kept_responses) const
+{
+    cv::Mat r = responses.reshape(1, data.rows);
+
+    cv::Mat samples((int) kept.size(), data.cols, data.type());
+    cv::Mat classes((int) kept.size(), 1, CV_32FC1);
+
+    for (size_t i = 0; i < kept.size(); i++)
+    {
+        cv::Mat row = samples.row((int) i);
+        data.row(kept[i]).copyTo(row);
+        classes.at<float>((int) i, 0) = r.at<float>(kept[i], 0);
+    }
+
+    kept_data = samples;
+    kept_responses = classes;
+}
+
+double PrototypeSelector::accuracy(const cv::Mat& training_data, const cv::Mat& training_responses,
+                                   const cv::Mat& testing_data, const cv::Mat& testing_responses,
+                                   int k)
+{
+    CvKNearest knn;
+    knn.train(training_data, training_responses, cv::Mat(), false, k);
+
+    cv::Mat results;
+    knn.find_nearest(testing_data, k, &results);
+
+    cv::Mat t = testing_responses.reshape(1, testing_data.rows);
+
+    int correct = 0;
+    for (int i = 0; i < testing_data.rows; i++)
+    {
+        correct += (fabs(results.at<float>(i, 0) - t.at<float>(i, 0)) < FLT_EPSILON);
+    }
+
+    return (double) correct / testing_data.rows;
+}
+
+const char* PrototypeSelector::method_name(int method)
+{
+    switch (method)
+    {
+    case PROTOTYPES_EDITED:
+        return "edited";
+    case PROTOTYPES_CONDENSED:
+        return "condensed";
+    case PROTOTYPES_EDITED_CONDENSED:
+        return "edited + condensed";
+    default:
+        return "all";
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,105 @@
+// Library : training set reduction for nearest neighbour classification
+// (edited and condensed nearest neighbour)
+
+// A kNN classifier stores every training sample and compares each query with
+// all of them. Wilson's editing [Wilson 1972] removes the samples that are
+// misclassified by their own k nearest (other) samples - noise, and overlap
+// between the classes - and Hart's condensing [Hart 1968] then keeps only a
+// subset (mostly near the class boundaries) by which every one of the
+// remaining samples is still classified correctly by its nearest neighbour.
+// select() tries the reductions from the most to the least aggressive
+// (edited then condensed, condensed, edited) and keeps the first whose
+// accuracy on a validation set is within a tolerance of that of the whole
+// training set - falling back to keeping every sample.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_PROTOTYPE_SELECT_H
+#define ML_PROTOTYPE_SELECT_H
+
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+/******************************************************************************/
+
+// reductions, from the least to the most aggressive
+
+enum
+{
+    PROTOTYPES_ALL = 0,
+    PROTOTYPES_EDITED,
+    PROTOTYPES_CONDENSED,
+    PROTOTYPES_EDITED_CONDENSED,
+    PROTOTYPES_METHODS
+};
+
+class PrototypeSelector
+{
+public:
+
+    PrototypeSelector();
+
+    // keep every one of n_rows samples
+
+    void reset(int n_rows);
+
+    // of the samples kept so far (rows of data, CV_32FC1, with classes in
+    // responses, CV_32FC1), keep those whose k nearest other kept samples
+    // vote for their own class (Wilson editing)
+
+    void edit(const cv::Mat& data, const cv::Mat& responses, int k = 3);
+
+    // of the samples kept so far, keep a subset that classifies all of them
+    // correctly by the nearest neighbour (Hart condensing)
+
+    void condense(const cv::Mat& data, const cv::Mat& responses);
+
+    // keep the samples given by method (PROTOTYPES_...), starting from all
+
+    void apply(int method, const cv::Mat& data, const cv::Mat& responses, int edit_k = 3);
+
+    // apply the most aggressive method whose kNN (k) accuracy on the
+    // validation samples is no more than tolerance (a fraction, e.g. 0.01 =
+    // one percentage point) below that of all of the samples - returns the
+    // method chosen
+
+    int select(const cv::Mat& data, const cv::Mat& responses,
+               const cv::Mat& validation_data, const cv::Mat& validation_responses,
+               int k = 1, double tolerance = 0.01, int edit_k = 3);
+
+    // copy the kept samples (and their classes)
+
+    void transform(const cv::Mat& data, const cv::Mat& responses,
+                   cv::Mat& kept_data, cv::Mat& kept_responses) const;
+
+    // kNN (k) accuracy (fraction correct) on the testing samples of a
+    // classifier storing the training samples
+
+    static double accuracy(const cv::Mat& training_data, const cv::Mat& training_responses,
+                           const cv::Mat& testing_data, const cv::Mat& testing_responses,
+                           int k);
+
+    static const char* method_name(int method);
+
+    int selected() const { return (int) kept.size(); }
+    int input_rows() const { return n_rows; }
+    int method() const { return chosen; }
+
+    // validation accuracy of each method tried by select() (-1 if not tried)
+
+    double validation_accuracy(int method) const { return accuracies[method]; }
+
+    // indices (in increasing order) of the rows kept
+
+    const std::vector<int>& rows() const { return kept; }
+
+protected:
+
+    std::vector<int> kept;
+    int n_rows;
+    int chosen;
+    double accuracies[PROTOTYPES_METHODS];
+};
+
+#endif // ML_PROTOTYPE_SELECT_H
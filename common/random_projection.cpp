@@ -0,0 +1,129 @@
+// Library : sparse random projection (Achlioptas) for very wide samples
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "random_projection.h"
+
+#include "csv_rows.h"
+
+#include <algorithm>
+#include <math.h>
+
+/******************************************************************************/
+
+#define PROJECT_ROWS_PER_TASK 256
+
+/******************************************************************************/
+
+SparseRandomProjection::SparseRandomProjection(int input_dims, int output_dims,
+                                               uint64 seed, double s)
+    : n_inputs(input_dims), n_outputs(output_dims)
+{
+    if (s < 1)
+    {
+        s = std::max(1.0, sqrt((double) input_dims));
+    }
+    scale = (float) sqrt(s / output_dims);
+
+    // draw the matrix an input attribute at a time (so that a row can be
+    // projected by running through its attributes once)
+
+    cv::RNG rng(seed);
+    double p_nonzero = 1.0 / s;
+
+    offsets.resize(n_inputs + 1);
+    for (int i = 0; i < n_inputs; i++)
+    {
+        offsets[i] = (int) targets.size();
+        for (int o = 0; o < n_outputs; o++)
+        {
+            double u = rng.uniform(0.0, 1.0);
+            if (u < p_nonzero)
+            {
+                targets.push_back(o);
+                negative.push_back(u < (p_nonzero / 2));
+            }
+        }
+    }
+    offsets[n_inputs] = (int) targets.size();
+}
+
+/******************************************************************************/
+
+void SparseRandomProjection::project(const float* in, float* out) const
+{
+    std::fill(out, out + n_outputs, 0.0f);
+
+    for (int i = 0; i < n_inputs; i++)
+    {
+        float x = in[i];
+        if (x == 0)
+        {
+            continue; // (common in wide, sparse, data)
+        }
+        for (int k = offsets[i]; k < offsets[i + 1]; k++)
+        {
+            out[targets[k]] += negative[k] ? -x : x;
+        }
+    }
+
+    for (int o = 0; o < n_outputs; o++)
+    {
+        out[o] *= scale;
+    }
+}
+
+void SparseRandomProjection::project(const cv::Mat& data, cv::Mat& projected,
+                                     ThreadPool& pool) const
+{
+    CV_Assert((data.cols == n_inputs) && (data.type() == CV_32FC1));
+
+    // (a new matrix, so that data and projected may be the same object)
+
+    cv::Mat result(data.rows, n_outputs, CV_32FC1);
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            project(data.ptr<float>(r), result.ptr<float>(r));
+        }
+    }, PROJECT_ROWS_PER_TASK);
+
+    projected = result;
+}
+
+/******************************************************************************/
+
+bool load_projected_csv(const char* filename, int n_samples,
+                        const SparseRandomProjection& projection,
+                        cv::Mat& data, cv::Mat& responses)
+{
+    CSVRowReader reader(filename);
+    if (!reader.is_open())
+    {
+        return false;
+    }
+
+    data = cv::Mat(n_samples, projection.output_dims(), CV_32FC1);
+    responses = cv::Mat(n_samples, 1, CV_32FC1);
+
+    // only one (original width) row is ever held in memory
+
+    std::vector<float> row(projection.input_dims() + 1);
+
+    for (int line = 0; line < n_samples; line++)
+    {
+        if (!reader.next_row() || !reader.numbers(0, (int) row.size(), &row[0]))
+        {
+            return false;
+        }
+
+        projection.project(&row[0], data.ptr<float>(line));
+        responses.at<float>(line, 0) = row[projection.input_dims()];
+    }
+
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,76 @@
+// Library : sparse random projection (Achlioptas) for very wide samples
+
+// Projects samples with many attributes down to output_dims by a random
+// matrix whose entries are +sqrt(s), 0 or -sqrt(s) with probabilities
+// 1/2s, 1 - 1/s and 1/2s [Achlioptas 2003] (scaled by 1 / sqrt(output_dims)),
+// which preserves distances between samples approximately. Unlike PCA
+// nothing needs to be fitted to the data - the matrix depends only on the
+// dimensions and the seed - so each sample can be projected as it is read
+// (load_projected_csv()) and only the reduced rows are ever stored.
+
+// s = 3 is Achlioptas' original choice (a third of the entries non-zero);
+// s = 0 uses sqrt(input_dims) [Li et al. 2006] which is much sparser still.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_RANDOM_PROJECTION_H
+#define ML_RANDOM_PROJECTION_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+class SparseRandomProjection
+{
+public:
+
+    SparseRandomProjection(int input_dims, int output_dims,
+                           uint64 seed = 0x12345678, double s = 0);
+
+    // project one sample (input_dims values) to out (output_dims values)
+
+    void project(const float* in, float* out) const;
+
+    // project every row of data (n x input_dims, CV_32FC1) giving n x
+    // output_dims - rows are projected in parallel blocks on the pool
+
+    void project(const cv::Mat& data, cv::Mat& projected,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    int input_dims() const { return n_inputs; }
+    int output_dims() const { return n_outputs; }
+
+    // number of non-zero entries of the projection matrix
+
+    int non_zeros() const { return (int) targets.size(); }
+
+private:
+
+    int n_inputs;
+    int n_outputs;
+    float scale;                 // sqrt(s / output_dims)
+
+    // non-zero entries by input attribute : those of input i are
+    // targets / negative [offsets[i] ... offsets[i + 1] - 1]
+
+    std::vector<int> offsets;
+    std::vector<int> targets;    // output the input is added to ...
+    std::vector<char> negative;  // ... or subtracted from
+};
+
+/******************************************************************************/
+
+// load n_samples rows of a CSV file of projection.input_dims() numerical
+// attributes followed by the class label, projecting each row as it is read
+// (data is n_samples x projection.output_dims(), responses n_samples x 1) -
+// returns false if the file cannot be read or has too few rows
+
+bool load_projected_csv(const char* filename, int n_samples,
+                        const SparseRandomProjection& projection,
+                        cv::Mat& data, cv::Mat& responses);
+
+#endif // ML_RANDOM_PROJECTION_H
@@ -0,0 +1,189 @@
+// Library : class and sample weights for imbalanced training data
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "sample_weights.h"
+
+#include <algorithm>
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+void ClassWeights::fit(const cv::Mat& responses, const cv::Mat& sample_weights,
+                       bool balanced)
+{
+    CV_Assert(responses.type() == CV_32FC1);
+    CV_Assert(sample_weights.empty() ||
+              ((sample_weights.type() == CV_32FC1) &&
+               (sample_weights.total() == responses.total())));
+
+    int n = (int) responses.total();
+    cv::Mat r = responses.reshape(1, n);
+    cv::Mat w = sample_weights.empty() ? cv::Mat() : sample_weights.reshape(1, n);
+
+    // the distinct class labels (integer valued, as by the trainers)
+
+    labels.clear();
+    for (int i = 0; i < n; i++)
+    {
+        labels.push_back((float) cvRound(r.at<float>(i, 0)));
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    counts.assign(labels.size(), 0);
+    totals.assign(labels.size(), 0.0);
+    scales.assign(labels.size(), 1.0);
+
+    std::vector<double> firsts(labels.size(), 0.0);
+    varied = false;
+
+    double total = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int c = index(r.at<float>(i, 0));
+        double wi = w.empty() ? 1.0 : (double) w.at<float>(i, 0);
+
+        if (counts[c] == 0)
+        {
+            firsts[c] = wi;
+        }
+        varied = varied || (wi != firsts[c]);
+
+        counts[c]++;
+        totals[c] += wi;
+        total += wi;
+    }
+
+    if (varied)
+    {
+        printf("WARNING: sample weights vary within a class - priors() and "
+               "svm_class_weights() use only the weight of each class\n");
+    }
+
+    if (balanced)
+    {
+        // every class then carries an equal share of the overall weight
+
+        for (size_t c = 0; c < labels.size(); c++)
+        {
+            if (totals[c] > 0)
+            {
+                scales[c] = (total / labels.size()) / totals[c];
+                totals[c] *= scales[c];
+            }
+        }
+    }
+}
+
+int ClassWeights::index(float label) const
+{
+    std::vector<float>::const_iterator it =
+        std::lower_bound(labels.begin(), labels.end(), (float) cvRound(label));
+
+    if ((it == labels.end()) || (*it != (float) cvRound(label)))
+    {
+        return -1;
+    }
+    return (int) (it - labels.begin());
+}
+
+/******************************************************************************/
+
+float ClassWeights::weight(int c) const
+{
+    return (counts[c] > 0) ? (float) (totals[c] / counts[c]) : 0.0f;
+}
+
+float ClassWeights::weight_of(float label) const
+{
+    int c = index(label);
+    return (c < 0) ? 0.0f : weight(c);
+}
+
+cv::Mat ClassWeights::sample_weights(const cv::Mat& responses,
+                                     const cv::Mat& sample_weights) const
+{
+    int n = (int) responses.total();
+    cv::Mat r = responses.reshape(1, n);
+    cv::Mat w = sample_weights.empty() ? cv::Mat() : sample_weights.reshape(1, n);
+    cv::Mat result(n, 1, CV_32FC1);
+
+    for (int i = 0; i < n; i++)
+    {
+        int c = index(r.at<float>(i, 0));
+        double wi = w.empty() ? 1.0 : (double) w.at<float>(i, 0);
+
+        result.at<float>(i, 0) = (c < 0) ? 0.0f : (float) (wi * scales[c]);
+    }
+
+    return result;
+}
+
+std::vector<float> ClassWeights::priors() const
+{
+    return std::vector<float>(totals.begin(), totals.end());
+}
+
+cv::Mat ClassWeights::svm_class_weights() const
+{
+    cv::Mat result(1, classes(), CV_64FC1);
+    for (int c = 0; c < classes(); c++)
+    {
+        result.at<double>(0, c) = weight(c);
+    }
+    return result;
+}
+
+/******************************************************************************/
+
+float ClassWeights::vote(const float* neighbour_responses, int k) const
+{
+    std::vector<double> votes(labels.size(), 0.0);
+
+    for (int i = 0; i < k; i++)
+    {
+        int c = index(neighbour_responses[i]);
+        if (c >= 0)
+        {
+            votes[c] += weight(c);
+        }
+    }
+
+    // (ties go to the lower label)
+
+    int best = (int) (std::max_element(votes.begin(), votes.end()) - votes.begin());
+
+    return labels.empty() ? 0.0f : labels[best];
+}
+
+float ClassWeights::vote(const int* neighbours, int k, const cv::Mat& responses,
+                         const cv::Mat& weights) const
+{
+    CV_Assert((responses.type() == CV_32FC1) && (weights.type() == CV_32FC1) &&
+              (weights.total() == responses.total()));
+
+    int n = (int) responses.total();
+    cv::Mat r = responses.reshape(1, n);
+    cv::Mat w = weights.reshape(1, n);
+
+    std::vector<double> votes(labels.size(), 0.0);
+
+    for (int i = 0; i < k; i++)
+    {
+        int c = index(r.at<float>(neighbours[i], 0));
+        if (c >= 0)
+        {
+            votes[c] += w.at<float>(neighbours[i], 0);
+        }
+    }
+
+    // (ties go to the lower label)
+
+    int best = (int) (std::max_element(votes.begin(), votes.end()) - votes.begin());
+
+    return labels.empty() ? 0.0f : labels[best];
+}
+
+/******************************************************************************/
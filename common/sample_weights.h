@@ -0,0 +1,108 @@
+// Library : class and sample weights for imbalanced training data
+
+// Rather than duplicating the samples of the rarer classes until the classes
+// are balanced (which multiplies the training cost), each sample is given a
+// weight - from the class counts, from a weight column in the data file, or
+// both - and the weights are handed to each trainer in the form it accepts:
+
+//   + neural networks : per sample weights (CvANN_MLP::train sampleWeights)
+//   + kNN : each neighbour's vote is weighted by that training sample's own
+//     weight (given the neighbours' rows, e.g. from GemmKNearest)
+//   + decision trees / boosted trees : priors (CvDTreeParams::priors), the
+//     total weight of each class (OpenCV divides them by the class counts)
+//   + SVM : class weights (CvSVMParams::class_weights), scaling C per class
+
+// N.B. OpenCV 2.4's CvDTree, CvBoost and CvSVM have no per sample weights,
+// only per class ones - for these the sample weights are reduced to the
+// total (or mean) weight of each class, so two samples of the same class
+// with weights 1 and 100 train them identically. fit() warns when the given
+// weights vary within a class (see varies_within_class()).
+
+// Classes are indexed in increasing order of their (integer) labels, as by
+// the OpenCV trainers.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_SAMPLE_WEIGHTS_H
+#define ML_SAMPLE_WEIGHTS_H
+
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+/******************************************************************************/
+
+class ClassWeights
+{
+public:
+
+    ClassWeights() : varied(false) {}
+
+    // weights of the classes of responses (one per sample, CV_32FC1) - given
+    // per sample weights (e.g. from a weight column, CV_32FC1) each class is
+    // weighted by its total sample weight rather than by its count; balanced
+    // then rescales the classes to equal total weight (as the mean over all
+    // the samples), so each sample of class c has weight n / (classes * n_c)
+
+    void fit(const cv::Mat& responses, const cv::Mat& sample_weights = cv::Mat(),
+             bool balanced = true);
+
+    // whether the sample weights given to fit() differ between samples of
+    // the same class (and so are only approximated by priors(),
+    // svm_class_weights() and the class weighted vote())
+
+    bool varies_within_class() const { return varied; }
+
+    int classes() const { return (int) labels.size(); }
+    float label(int c) const { return labels[c]; }
+
+    // index of a class label (-1 if the label was not seen)
+
+    int index(float label) const;
+
+    // mean weight of the samples of class c, and of a class label (0 if the
+    // label was not seen)
+
+    float weight(int c) const;
+    float weight_of(float label) const;
+
+    // per sample weights of responses (CV_32FC1 column) : the class scaling
+    // times the given sample weights (or 1), for CvANN_MLP::train
+
+    cv::Mat sample_weights(const cv::Mat& responses,
+                           const cv::Mat& sample_weights = cv::Mat()) const;
+
+    // total weight of each class, for CvDTreeParams::priors (as float*) -
+    // class totals only, see above
+
+    std::vector<float> priors() const;
+
+    // mean sample weight of each class (1 x classes, CV_64FC1), for
+    // CvSVMParams::class_weights (as CvMat*) - class means only, see above
+
+    cv::Mat svm_class_weights() const;
+
+    // class label with the largest total weight amongst k neighbour responses
+    // (e.g. from CvKNearest::find_nearest), each neighbour voting with the
+    // mean weight of its class
+
+    float vote(const float* neighbour_responses, int k) const;
+
+    // class label with the largest total weight amongst k neighbours given as
+    // rows of the training data (e.g. GemmKNearest::find_nearest indices),
+    // each neighbour voting with its own weight - weights being the per
+    // sample weights of the training samples (from sample_weights())
+
+    float vote(const int* neighbours, int k, const cv::Mat& responses,
+               const cv::Mat& weights) const;
+
+private:
+
+    std::vector<float> labels;  // class labels, in increasing order
+    std::vector<int> counts;    // samples of each class
+    std::vector<double> totals; // total (scaled) weight of each class
+    std::vector<double> scales; // balancing scale of each class (or 1)
+    bool varied;                // sample weights differ within a class
+};
+
+#endif // ML_SAMPLE_WEIGHTS_H
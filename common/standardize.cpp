@@ -0,0 +1,140 @@
+// Library : feature standardization from streaming (Welford) statistics
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "standardize.h"
+
+#include <mutex>
+
+#include <math.h>
+
+/******************************************************************************/
+
+#define STATS_ROWS_PER_TASK 1024
+
+/******************************************************************************/
+
+RunningStats::RunningStats(int dims) : n(0), means(dims, 0.0), m2(dims, 0.0)
+{
+}
+
+void RunningStats::add(const float* sample)
+{
+    n++;
+    for (size_t i = 0; i < means.size(); i++)
+    {
+        double delta = sample[i] - means[i];
+        means[i] += delta / n;
+        m2[i] += delta * (sample[i] - means[i]);
+    }
+}
+
+void RunningStats::add(const cv::Mat& data)
+{
+    CV_Assert((data.cols == dims()) && (data.type() == CV_32FC1));
+
+    for (int r = 0; r < data.rows; r++)
+    {
+        add(data.ptr<float>(r));
+    }
+}
+
+void RunningStats::merge(const RunningStats& other)
+{
+    if (other.n == 0)
+    {
+        return;
+    }
+    if (n == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    CV_Assert(other.dims() == dims());
+
+    double total = (double) n + other.n;
+    for (size_t i = 0; i < means.size(); i++)
+    {
+        double delta = other.means[i] - means[i];
+        means[i] += delta * other.n / total;
+        m2[i] += other.m2[i] + delta * delta * ((double) n * other.n / total);
+    }
+    n += other.n;
+}
+
+RunningStats compute_stats(const cv::Mat& data, ThreadPool& pool)
+{
+    RunningStats stats(data.cols);
+    std::mutex lock;
+
+    pool.parallel_for(0, data.rows, [&](int begin, int end)
+    {
+        RunningStats partial(data.cols);
+        partial.add(data.rowRange(begin, end));
+
+        std::lock_guard<std::mutex> guard(lock);
+        stats.merge(partial);
+    }, STATS_ROWS_PER_TASK);
+
+    return stats;
+}
+
+/******************************************************************************/
+
+void Standardizer::fit(const RunningStats& stats)
+{
+    offset.resize(stats.dims());
+    scale.resize(stats.dims());
+
+    for (int i = 0; i < stats.dims(); i++)
+    {
+        double stddev = sqrt(stats.variance(i));
+        offset[i] = (float) stats.mean(i);
+        scale[i] = (stddev > FLT_EPSILON) ? (float) (1.0 / stddev) : 1.0f;
+    }
+}
+
+void Standardizer::apply(float* sample) const
+{
+    for (size_t i = 0; i < offset.size(); i++)
+    {
+        sample[i] = (sample[i] - offset[i]) * scale[i];
+    }
+}
+
+void Standardizer::apply(cv::Mat& data) const
+{
+    CV_Assert((data.cols == dims()) && (data.type() == CV_32FC1));
+
+    for (int r = 0; r < data.rows; r++)
+    {
+        apply(data.ptr<float>(r));
+    }
+}
+
+/******************************************************************************/
+
+void Standardizer::write(cv::FileStorage& fs, const char* name) const
+{
+    fs << name << "{"
+       << "mean" << offset
+       << "scale" << scale
+       << "}";
+}
+
+bool Standardizer::read(const cv::FileStorage& fs, const char* name)
+{
+    cv::FileNode node = fs[name];
+    if (node.empty())
+    {
+        return false;
+    }
+
+    node["mean"] >> offset;
+    node["scale"] >> scale;
+
+    return offset.size() == scale.size();
+}
+
+/******************************************************************************/
@@ -0,0 +1,90 @@
+// Library : feature standardization from streaming (Welford) statistics
+
+// The mean and variance of every attribute are accumulated one sample at a
+// time in a single pass [Welford 1962] - numerically stable, so the samples
+// never need to be stored first - and partial statistics (e.g. one per
+// thread, or per chunk of a file) can be merged [Chan et al. 1979]. A
+// Standardizer built from them then rescales samples in place to zero mean
+// and unit variance, so attributes of very different ranges (e.g. 0.05 to
+// 2500 in wdbc) contribute comparably to SVM kernels and kNN distances.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_STANDARDIZE_H
+#define ML_STANDARDIZE_H
+
+#include "opencv2/core/core.hpp"
+
+#include "threadpool.h"
+
+#include <vector>
+
+/******************************************************************************/
+
+// per attribute running mean and variance
+
+class RunningStats
+{
+public:
+
+    explicit RunningStats(int dims = 0);
+
+    // add one sample (dims values), or every row of data (CV_32FC1)
+
+    void add(const float* sample);
+    void add(const cv::Mat& data);
+
+    // combine with statistics of other samples (of the same dims)
+
+    void merge(const RunningStats& other);
+
+    int dims() const { return (int) means.size(); }
+    long count() const { return n; }
+
+    double mean(int i) const { return means[i]; }
+    double variance(int i) const { return (n > 0) ? (m2[i] / n) : 0; }
+
+private:
+
+    long n;
+    std::vector<double> means;
+    std::vector<double> m2;     // sum of squared differences from the mean
+};
+
+// statistics of every row of data, accumulated over chunks of rows in
+// parallel on the pool and then merged
+
+RunningStats compute_stats(const cv::Mat& data, ThreadPool& pool = ThreadPool::global());
+
+/******************************************************************************/
+
+class Standardizer
+{
+public:
+
+    // scaling to zero mean, unit variance (attributes with no variance are
+    // only centred)
+
+    void fit(const RunningStats& stats);
+    void fit(const cv::Mat& data) { fit(compute_stats(data)); }
+
+    // rescale one sample (dims values), or every row of data, in place
+
+    void apply(float* sample) const;
+    void apply(cv::Mat& data) const;
+
+    bool empty() const { return offset.empty(); }
+    int dims() const { return (int) offset.size(); }
+
+    // storage (as a map called name, e.g. within the model's file)
+
+    void write(cv::FileStorage& fs, const char* name = "standardizer") const;
+    bool read(const cv::FileStorage& fs, const char* name = "standardizer");
+
+private:
+
+    std::vector<float> offset;  // mean of each attribute
+    std::vector<float> scale;   // 1 / standard deviation of each attribute
+};
+
+#endif // ML_STANDARDIZE_H
@@ -0,0 +1,484 @@
+// Library : work-stealing thread pool shared by all of the examples and tools
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "threadpool.h"
+
+#include <algorithm>
+#include <new>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/******************************************************************************/
+
+// the pool (if any) that owns the calling thread and the thread's index in it
+
+static thread_local ThreadPool* owner_pool = NULL;
+static thread_local int owner_index = 0;
+
+/******************************************************************************/
+
+ScratchArena::ScratchArena(size_t size)
+    : current(0), offset(0), block_size(size)
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        free(blocks[i].data);
+    }
+}
+
+// N.B. alignment must be a power of two
+
+void* ScratchArena::allocate(size_t bytes, size_t alignment)
+{
+    if (bytes == 0)
+    {
+        bytes = 1;
+    }
+
+    for (;;)
+    {
+        // past the last block => add a new one big enough for this request
+
+        if (current == blocks.size())
+        {
+            Block b;
+            b.size = std::max(block_size, bytes + alignment);
+            b.data = (char *) malloc(b.size);
+            if (!b.data)
+            {
+                throw std::bad_alloc();
+            }
+            blocks.push_back(b);
+            offset = 0;
+        }
+
+        Block& b = blocks[current];
+        uintptr_t base = (uintptr_t) b.data;
+        size_t start = (size_t) (((base + offset + alignment - 1)
+                                  & ~((uintptr_t) alignment - 1)) - base);
+
+        if (start + bytes <= b.size)
+        {
+            offset = start + bytes;
+            return b.data + start;
+        }
+
+        if (offset == 0)
+        {
+            // an unused block that is too small => replace it with a larger one
+
+            free(b.data);
+            b.size = std::max(block_size, bytes + alignment);
+            b.data = (char *) malloc(b.size);
+            if (!b.data)
+            {
+                throw std::bad_alloc();
+            }
+            continue;
+        }
+
+        // otherwise move on to the next block
+
+        current++;
+        offset = 0;
+    }
+}
+
+ScratchArena::Mark ScratchArena::mark() const
+{
+    Mark m;
+    m.block = current;
+    m.offset = offset;
+    return m;
+}
+
+void ScratchArena::release(const Mark& m)
+{
+    current = m.block;
+    offset = m.offset;
+}
+
+void ScratchArena::reset()
+{
+    current = 0;
+    offset = 0;
+}
+
+/******************************************************************************/
+
+// pins the calling thread to the specified CPU
+
+static void pin_to_cpu(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+#else
+    (void) cpu;
+#endif
+}
+
+// the CPUs this process is allowed to run on
+
+static std::vector<int> allowed_cpus()
+{
+    std::vector<int> cpus;
+
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    return cpus;
+}
+
+/******************************************************************************/
+
+ThreadPool::ThreadPool(int threads, bool pin)
+    : n_threads(threads), pin_threads(pin), pending(0), stopping(false)
+{
+    if (n_threads <= 0)
+    {
+        const char* env = getenv("ML_NUM_THREADS");
+        n_threads = env ? atoi(env) : 0;
+    }
+    if (n_threads <= 0)
+    {
+        n_threads = std::max(1, (int) std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < n_threads; i++)
+    {
+        queues.push_back(new TaskQueue);
+        queues[i]->n_bound = 0;
+    }
+
+    // worker i is pinned to the i-th CPU we are allowed to use (wrapping
+    // around if there are more workers than CPUs)
+
+    cpu_of_thread.assign(n_threads, -1);
+    if (pin_threads)
+    {
+        std::vector<int> cpus = allowed_cpus();
+        for (int i = 1; (i < n_threads) && !cpus.empty(); i++)
+        {
+            cpu_of_thread[i] = cpus[(i - 1) % cpus.size()];
+        }
+    }
+
+    // thread 0 is whichever thread waits on a task group, so only start
+    // workers 1 ... n_threads - 1
+
+    for (int i = 1; i < n_threads; i++)
+    {
+        workers.push_back(std::thread([this, i]()
+        {
+            if (cpu_of_thread[i] >= 0)
+            {
+                pin_to_cpu(cpu_of_thread[i]);
+            }
+            worker_loop(i);
+        }));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        delete queues[i];
+    }
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool(0, getenv("ML_PIN_THREADS")
+                           && (atoi(getenv("ML_PIN_THREADS")) != 0));
+    return pool;
+}
+
+int ThreadPool::current_thread_index()
+{
+    return owner_index;
+}
+
+int ThreadPool::thread_cpu(int index) const
+{
+    return ((index >= 0) && (index < n_threads)) ? cpu_of_thread[index] : -1;
+}
+
+ScratchArena& ThreadPool::scratch_arena()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+/******************************************************************************/
+
+void ThreadPool::push(Task* task)
+{
+    // workers push onto their own queue, everyone else onto the shared one
+
+    int self = (owner_pool == this) ? owner_index : 0;
+    {
+        std::lock_guard<std::mutex> guard(queues[self]->lock);
+        queues[self]->tasks.push_back(task);
+    }
+
+    pending++;
+
+    // taking the lock (however briefly) before notifying means a worker
+    // cannot miss the wake up between checking pending and going to sleep
+
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::push_to(int index, Task* task)
+{
+    TaskQueue* queue = queues[index % n_threads];
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->bound.push_back(task);
+    }
+
+    queue->n_bound++;
+
+    // only the one thread can take it, so wake everyone to be sure it sees it
+
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+    }
+    wake.notify_all();
+}
+
+ThreadPool::Task* ThreadPool::pop_or_steal(int self)
+{
+    Task* task = NULL;
+
+    // tasks bound to this thread first, then the newest task from our own
+    // queue (it is the most likely to still be in cache), otherwise steal
+    // the oldest task from someone else
+
+    {
+        std::lock_guard<std::mutex> guard(queues[self]->lock);
+        if (!queues[self]->bound.empty())
+        {
+            task = queues[self]->bound.front();
+            queues[self]->bound.pop_front();
+            queues[self]->n_bound--;
+            return task;
+        }
+        if (!queues[self]->tasks.empty())
+        {
+            task = queues[self]->tasks.back();
+            queues[self]->tasks.pop_back();
+        }
+    }
+
+    for (int i = 1; (!task) && (i < n_threads); i++)
+    {
+        TaskQueue* victim = queues[(self + i) % n_threads];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (!victim->tasks.empty())
+        {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+        }
+    }
+
+    if (task)
+    {
+        pending--;
+    }
+
+    return task;
+}
+
+void ThreadPool::execute(Task* task)
+{
+    try
+    {
+        task->fn();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(task->group->error_lock);
+        if (!task->group->error)
+        {
+            task->group->error = std::current_exception();
+        }
+    }
+
+    TaskGroup* group = task->group;
+    delete task;
+    group->outstanding--;
+}
+
+void ThreadPool::worker_loop(int index)
+{
+    owner_pool = this;
+    owner_index = index;
+
+    for (;;)
+    {
+        Task* task = pop_or_steal(index);
+        if (task)
+        {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_lock);
+        wake.wait(lock, [this, index]()
+        {
+            return stopping || (pending > 0) || (queues[index]->n_bound > 0);
+        });
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallel_for(int begin, int end,
+                              const std::function<void (int, int)>& body, int grain)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    int n = end - begin;
+    if (grain <= 0)
+    {
+        grain = std::max(1, n / (n_threads * 4));
+    }
+
+    // not worth splitting => run it here
+
+    if ((n <= grain) || (n_threads == 1))
+    {
+        body(begin, end);
+        return;
+    }
+
+    TaskGroup group(*this);
+    for (int start = begin; start < end; start += grain)
+    {
+        int stop = std::min(end, start + grain);
+        group.run([&body, start, stop]() { body(start, stop); });
+    }
+    group.wait();
+}
+
+/******************************************************************************/
+
+TaskGroup::TaskGroup(ThreadPool& p) : pool(p), outstanding(0)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    // never leave tasks running that refer to this group
+
+    while (outstanding > 0)
+    {
+        int self = (owner_pool == &pool) ? owner_index : 0;
+        ThreadPool::Task* task = pool.pop_or_steal(self);
+        if (task)
+        {
+            pool.execute(task);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskGroup::run(const std::function<void ()>& fn)
+{
+    ThreadPool::Task* task = new ThreadPool::Task;
+    task->fn = fn;
+    task->group = this;
+
+    outstanding++;
+    pool.push(task);
+}
+
+void TaskGroup::run_on(int index, const std::function<void ()>& fn)
+{
+    ThreadPool::Task* task = new ThreadPool::Task;
+    task->fn = fn;
+    task->group = this;
+
+    outstanding++;
+    pool.push_to(index, task);
+}
+
+void TaskGroup::wait()
+{
+    int self = (owner_pool == &pool) ? owner_index : 0;
+
+    while (outstanding > 0)
+    {
+        ThreadPool::Task* task = pool.pop_or_steal(self);
+        if (task)
+        {
+            pool.execute(task);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr e;
+    {
+        std::lock_guard<std::mutex> guard(error_lock);
+        e = error;
+        error = std::exception_ptr();
+    }
+    if (e)
+    {
+        std::rethrow_exception(e);
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,222 @@
+// Library : work-stealing thread pool shared by all of the examples and tools
+// (parallel_for, task groups and per-thread scratch memory arenas)
+
+// The number of threads defaults to the number of hardware threads and can be
+// set with the environment variable ML_NUM_THREADS (ML_NUM_THREADS=1 runs
+// everything serially on the calling thread). Setting ML_PIN_THREADS=1 pins
+// each worker thread to a single CPU (Linux only).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#ifndef ML_THREADPOOL_H
+#define ML_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+/******************************************************************************/
+
+// bump pointer scratch memory owned by a single thread - individual
+// allocations are never freed, instead everything allocated after a mark()
+// is given back in one go by release() (or by a ScratchScope going out of
+// scope) and the underlying blocks are reused by the next allocations
+
+class ScratchArena
+{
+public:
+
+    struct Mark
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit ScratchArena(size_t block_size = 1 << 20);
+    ~ScratchArena();
+
+    void* allocate(size_t bytes, size_t alignment = 64);
+
+    template <typename T> T* allocate_array(size_t n)
+    {
+        return static_cast<T*>(allocate(n * sizeof(T)));
+    }
+
+    Mark mark() const;
+    void release(const Mark& m);
+    void reset();
+
+private:
+
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    ScratchArena(const ScratchArena&);
+    ScratchArena& operator=(const ScratchArena&);
+
+    std::vector<Block> blocks;
+    size_t current;      // index of the block allocations come from
+    size_t offset;       // first free byte in that block
+    size_t block_size;   // default size of a new block
+};
+
+// releases everything allocated from an arena within the enclosing scope
+
+class ScratchScope
+{
+public:
+    explicit ScratchScope(ScratchArena& a) : arena(a), m(a.mark()) {}
+    ~ScratchScope() { arena.release(m); }
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark m;
+};
+
+/******************************************************************************/
+
+class TaskGroup;
+
+class ThreadPool
+{
+public:
+
+    // n_threads <= 0 => use ML_NUM_THREADS or the number of hardware threads
+    // (the thread that waits on a task group counts as one of the threads, so
+    // n_threads - 1 worker threads are actually started)
+
+    explicit ThreadPool(int n_threads = 0, bool pin_threads = false);
+    ~ThreadPool();
+
+    // the pool shared by everything in the process (configured from the
+    // environment on first use)
+
+    static ThreadPool& global();
+
+    // total number of threads that execute tasks (workers + waiting thread)
+
+    int thread_count() const { return n_threads; }
+
+    // index of the calling thread within the pool that owns it
+    // (1 ... thread_count() - 1 for workers, 0 for any other thread)
+
+    static int current_thread_index();
+
+    // CPU that thread index is pinned to (-1 if threads are not pinned or
+    // for thread 0, which is never pinned)
+
+    int thread_cpu(int index) const;
+
+    // scratch arena private to the calling thread
+
+    static ScratchArena& scratch_arena();
+
+    // run body(chunk_begin, chunk_end) over [begin, end) split into chunks of
+    // (at most) grain iterations - grain <= 0 picks a chunk size that gives
+    // every thread several chunks to balance the load by stealing
+
+    void parallel_for(int begin, int end,
+                      const std::function<void (int, int)>& body, int grain = 0);
+
+private:
+
+    friend class TaskGroup;
+
+    struct Task
+    {
+        std::function<void ()> fn;
+        TaskGroup* group;
+    };
+
+    // one double ended queue per thread : the owner pushes and pops at the
+    // back, idle threads steal from the front - tasks that must run on a
+    // particular thread go in a separate queue that is never stolen from
+
+    struct TaskQueue
+    {
+        std::mutex lock;
+        std::deque<Task*> tasks;
+        std::deque<Task*> bound;
+        std::atomic<int> n_bound;
+    };
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void push(Task* task);
+    void push_to(int index, Task* task);
+    Task* pop_or_steal(int self);
+    void execute(Task* task);
+    void worker_loop(int index);
+
+    int n_threads;
+    bool pin_threads;
+    std::vector<int> cpu_of_thread;
+
+    std::vector<std::thread> workers;
+    std::vector<TaskQueue*> queues;  // queues[0] is shared by non-worker threads
+
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<int> pending;        // tasks queued but not yet taken
+    bool stopping;
+};
+
+/******************************************************************************/
+
+// a set of tasks that can be waited on together - the waiting thread executes
+// queued tasks itself rather than blocking, so task groups can be nested
+// (i.e. a task may itself run and wait on another group)
+
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::global());
+    ~TaskGroup();
+
+    void run(const std::function<void ()>& fn);
+
+    // run fn on thread index of the pool (i.e. it will not be stolen by
+    // another thread) - used to keep work next to data the thread owns
+
+    void run_on(int index, const std::function<void ()>& fn);
+
+    // returns once all tasks have completed - rethrows the first exception
+    // thrown by any of the tasks
+
+    void wait();
+
+private:
+
+    friend class ThreadPool;
+
+    TaskGroup(const TaskGroup&);
+    TaskGroup& operator=(const TaskGroup&);
+
+    ThreadPool& pool;
+    std::atomic<int> outstanding;
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
+
+/******************************************************************************/
+
+// convenience wrapper for ThreadPool::global().parallel_for()
+
+inline void parallel_for(int begin, int end,
+                         const std::function<void (int, int)>& body, int grain = 0)
+{
+    ThreadPool::global().parallel_for(begin, end, body, grain);
+}
+
+#endif // ML_THREADPOOL_H
@@ -13,6 +13,10 @@
 
 using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
+#include "dtree_prune.h"
+#include "categorical_tree.h"
+#include "lookup_table.h"
+
 #include <stdio.h>
 
 /******************************************************************************/
@@ -26,6 +30,27 @@ using namespace cv; // OpenCV API is in the C++ "cv" namespace
 static char* CLASSES[NUMBER_OF_CLASSES] =
 {(char *) "unacc", (char *) "acc", (char *) "good", (char *) "vgood"};
 
+// prune by cross-validation with the folds run concurrently on the thread
+// pool (see common/dtree_prune.h) - the same pruned tree as CvDTree, which
+// is also trained for comparison
+
+#define USE_PARALLEL_PRUNING 1  // set to 0 for CvDTree's own (serial) pruning
+
+// with so few possible samples (4 * 4 * 4 * 3 * 3 * 3 = 1728 combinations of
+// the categories) the trained tree is compiled into a table of its
+// prediction for every one (see common/lookup_table.h), used instead of the
+// tree wherever the sample's categories were all seen in training
+
+#define USE_LOOKUP_TABLE 1  // set to 0 to predict with the tree itself
+
+// the tree is also flattened into an array of nodes testing each sample's
+// category codes (encoded once) against a bitmask per node (see
+// common/categorical_tree.h) - used for any sample the table cannot look up
+
+#define USE_FLAT_TREE 1  // set to 0 to predict with the tree itself
+
+#define TIMING_REPEATS 1000  // passes over the testing set when timing
+
 /******************************************************************************/
 
 // a basic hash function from: http://www.cse.yorku.ca/~oz/hash.html
@@ -45,6 +70,16 @@ int hash(char *str)
 
 /******************************************************************************/
 
+// time per prediction (in microseconds) of TIMING_REPEATS passes over the
+// testing set taking the given time (in seconds)
+
+double per_sample(double seconds)
+{
+    return seconds * 1e6 / ((double) TIMING_REPEATS * NUMBER_OF_TESTING_SAMPLES);
+}
+
+/******************************************************************************/
+
 // loads the sample database from file (which is a CSV text file)
 
 int read_data_from_csv(const char* filename, Mat data, Mat classes,
@@ -180,14 +215,140 @@ int main( int argc, char** argv )
         // train decision tree classifier (using training data)
 
         printf( "\nUsing training database: %s\n\n", argv[1]);
+
+#if (USE_PARALLEL_PRUNING)
+        CvDTree* dtree = new ParallelPruneDTree;
+
+        int64 start = getTickCount();
+        dtree->train(training_data, CV_ROW_SAMPLE, training_classifications,
+                     Mat(), Mat(), var_type, Mat(), params);
+        double parallel_time = (getTickCount() - start) / getTickFrequency();
+
+        // the same tree with OpenCV's serial pruning, for comparison
+
+        CvDTree serial_tree;
+
+        start = getTickCount();
+        serial_tree.train(training_data, CV_ROW_SAMPLE, training_classifications,
+                          Mat(), Mat(), var_type, Mat(), params);
+        double serial_time = (getTickCount() - start) / getTickFrequency();
+
+        printf("Training time : %g s (parallel pruning), %g s (serial pruning)\n"
+               "Pruned tree index : %d (parallel pruning), %d (serial pruning)\n",
+               parallel_time, serial_time,
+               dtree->get_pruned_tree_idx(), serial_tree.get_pruned_tree_idx());
+#else
         CvDTree* dtree = new CvDTree;
 
         dtree->train(training_data, CV_ROW_SAMPLE, training_classifications,
                      Mat(), Mat(), var_type, Mat(), params);
+#endif
+
+#if (USE_LOOKUP_TABLE || USE_FLAT_TREE)
+
+        // time prediction over the testing set by the tree itself
+
+        int64 tree_tick = getTickCount();
+        double tree_sum = 0;
+        for (int r = 0; r < TIMING_REPEATS; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                tree_sum += dtree->predict(testing_data.row(tsample), Mat(), false)->value;
+            }
+        }
+        double tree_time = (getTickCount() - tree_tick) / getTickFrequency();
+
+        printf("Prediction time per sample : %g us (tree)\n", per_sample(tree_time));
+#endif
+
+#if (USE_LOOKUP_TABLE)
+
+        // compile the tree into a lookup table (if the table is small enough)
+
+        CategoricalLookupTable table;
+        table.fit_categories(training_data);
+
+        int64 compile_start = getTickCount();
+        bool compiled = table.compile([&](const Mat& sample)
+        {
+            return (float) dtree->predict(sample, Mat(), false)->value;
+        });
+        double compile_time = (getTickCount() - compile_start) / getTickFrequency();
+
+        if (compiled)
+        {
+            // time prediction over the testing set by the table, falling back
+            // to the tree for samples with a category not seen in training
+            // (the difference of the sums of its and the tree's predictions
+            // should be 0)
+
+            int misses = 0;
+            int64 tick = getTickCount();
+            double difference = tree_sum;
+            for (int r = 0; r < TIMING_REPEATS; r++)
+            {
+                for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+                {
+                    float value;
+                    if (!table.predict(testing_data.ptr<float>(tsample), value))
+                    {
+                        value = (float) dtree->predict(testing_data.row(tsample), Mat(), false)->value;
+                        misses++;
+                    }
+                    difference -= value;
+                }
+            }
+            double table_time = (getTickCount() - tick) / getTickFrequency();
+
+            printf("Lookup table : %d entries, compiled in %g s (difference %g)\n"
+                   "Lookup table : %d of %d testing samples not in the table\n"
+                   "Prediction time per sample : %g us (table)\n",
+                   (int) table.size(), compile_time, difference,
+                   misses / TIMING_REPEATS, NUMBER_OF_TESTING_SAMPLES,
+                   per_sample(table_time));
+        }
+        else
+        {
+            printf("Lookup table : too many combinations, using the tree\n");
+        }
+#endif
+
+#if (USE_FLAT_TREE)
+
+        // flatten the tree into bitmask split nodes, then time prediction over
+        // the testing set by it (encoding each sample as it goes) in the same way
+
+        FlatCategoricalTree flat_tree;
+        bool flattened = flat_tree.compile(*dtree);
+
+        if (flattened)
+        {
+            int64 tick = getTickCount();
+            double difference = tree_sum;
+            for (int r = 0; r < TIMING_REPEATS; r++)
+            {
+                for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+                {
+                    difference -= flat_tree.predict(testing_data.ptr<float>(tsample));
+                }
+            }
+            double flat_time = (getTickCount() - tick) / getTickFrequency();
+
+            printf("Flat tree : %d nodes (difference %g)\n"
+                   "Prediction time per sample : %g us (flat tree)\n",
+                   flat_tree.size(), difference, per_sample(flat_time));
+        }
+        else
+        {
+            printf("Flat tree : the tree has ordered splits, using the tree\n");
+        }
+#endif
 
         // perform classifier testing and report results
 
         Mat test_sample;
+        float result;
         int correct_class = 0;
         int wrong_class = 0;
         int false_positives [NUMBER_OF_CLASSES] = {0,0,0,0};
@@ -203,21 +364,37 @@ int main( int argc, char** argv )
 
             // run decision tree prediction
 
-            resultNode = dtree->predict(test_sample, Mat(), false);
+            bool predicted = false;
+
+#if (USE_LOOKUP_TABLE)
+            predicted = compiled && table.predict(test_sample.ptr<float>(0), result);
+#endif
+#if (USE_FLAT_TREE)
+            if (!predicted && flattened)
+            {
+                result = flat_tree.predict(test_sample.ptr<float>(0));
+                predicted = true;
+            }
+#endif
+            if (!predicted)
+            {
+                resultNode = dtree->predict(test_sample, Mat(), false);
+                result = (float) resultNode->value;
+            }
 
-            printf("Testing Sample %i -> class result %s\n", tsample, CLASSES[(int) (resultNode->value)]);
+            printf("Testing Sample %i -> class result %s\n", tsample, CLASSES[(int) result]);
 
             // if the prediction and the (true) testing classification are the same
             // (N.B. openCV uses a floating point decision tree implementation!)
 
-            if (fabs(resultNode->value - testing_classifications.at<float>(tsample, 0))
+            if (fabs(result - testing_classifications.at<float>(tsample, 0))
                     >= FLT_EPSILON)
             {
                 // if they differ more than floating point error => wrong class
 
                 wrong_class++;
 
-                false_positives[(int) resultNode->value]++;
+                false_positives[(int) result]++;
 
             }
             else
@@ -0,0 +1,391 @@
+// Example : genetic algorithm (GA) optimisation of classifier hyperparameters
+// and feature subsets
+// usage: prog {svm|knn|rtrees|mlp} training_data_file testing_data_file [generations]
+
+// For use with test / training datasets : opticaldigits_ex (or any CSV file of
+// ATTRIBUTES_PER_SAMPLE attributes followed by an integer class)
+
+// A population of genomes - each a set of hyperparameter values for the
+// chosen classifier plus a mask of the attributes to use - is evolved to
+// maximise the accuracy on a validation set held out from the training data
+// (less a small cost per attribute used, favouring smaller subsets). Each
+// generation's genomes are trained and validated concurrently on the thread
+// pool (ML_NUM_THREADS) and genomes that recur are answered from a fitness
+// cache rather than trained again (see common/genetic.h). The best genome is
+// then retrained on all of the training data and tested, alongside the
+// classifier with its default hyperparameters and all of the attributes.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "csv_rows.h"
+#include "feature_select.h"
+#include "genetic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define VALIDATION_SAMPLES 956      // last quarter of the training data
+#define FEATURE_COST 0.0005         // fitness cost of each attribute used
+#define DEFAULT_GENERATIONS 20
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat& data, Mat& classes, int n_samples)
+{
+    // if we can't read the input file then return 0
+
+    CSVRowReader reader(filename);
+    if (!reader.is_open())
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    classes = Mat(n_samples, 1, CV_32FC1);
+
+    // attributes first, then the class label
+
+    for (int line = 0; line < n_samples; line++)
+    {
+        if (!reader.next_row() ||
+                !reader.numbers(0, ATTRIBUTES_PER_SAMPLE, data.ptr<float>(line)) ||
+                (reader.fields() <= ATTRIBUTES_PER_SAMPLE))
+        {
+            printf("ERROR: too few samples or attributes in file %s\n",  filename);
+            return 0; // all not OK
+        }
+        classes.at<float>(line, 0) = reader.number(ATTRIBUTES_PER_SAMPLE);
+    }
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// the classifiers : the hyperparameters searched (and their defaults)
+
+enum Classifier { SVM_RBF, KNN, RANDOM_FOREST, NEURAL_NETWORK };
+
+static std::vector<GeneRange> hyperparameters(Classifier classifier, std::vector<double>& defaults)
+{
+    std::vector<GeneRange> ranges;
+
+    switch (classifier)
+    {
+    case SVM_RBF:
+    {
+        GeneRange c = {"C", 0.01, 1000, 21, true, false};
+        GeneRange gamma = {"gamma", 0.00001, 1, 21, true, false};
+        ranges.push_back(c);
+        ranges.push_back(gamma);
+        defaults.push_back(1);
+        defaults.push_back(1.0 / ATTRIBUTES_PER_SAMPLE);
+        break;
+    }
+    case KNN:
+    {
+        GeneRange k = {"k", 1, 15, 15, false, true};
+        ranges.push_back(k);
+        defaults.push_back(3);
+        break;
+    }
+    case RANDOM_FOREST:
+    {
+        GeneRange depth = {"max depth", 2, 30, 15, false, true};
+        GeneRange active = {"active vars", 1, 16, 16, false, true};
+        GeneRange trees = {"trees", 10, 100, 10, false, true};
+        ranges.push_back(depth);
+        ranges.push_back(active);
+        ranges.push_back(trees);
+        defaults.push_back(25);
+        defaults.push_back(4);
+        defaults.push_back(100);
+        break;
+    }
+    case NEURAL_NETWORK:
+    {
+        GeneRange hidden = {"hidden nodes", 4, 64, 16, false, true};
+        GeneRange rate = {"learning rate", 0.01, 0.5, 11, true, false};
+        ranges.push_back(hidden);
+        ranges.push_back(rate);
+        defaults.push_back(10);
+        defaults.push_back(0.1);
+        break;
+    }
+    }
+
+    return ranges;
+}
+
+// train the classifier with the given hyperparameter values and return the
+// proportion of the testing samples it classifies correctly
+
+static double train_and_test(Classifier classifier, const std::vector<double>& values,
+                             const Mat& training_data, const Mat& training_classifications,
+                             const Mat& testing_data, const Mat& testing_classifications)
+{
+    Mat results = Mat(testing_data.rows, 1, CV_32FC1);
+
+    switch (classifier)
+    {
+    case SVM_RBF:
+    {
+        CvSVMParams params = CvSVMParams(CvSVM::C_SVC, CvSVM::RBF, 0.0, values[1], 0.0,
+                                         values[0], 0, 0, NULL,
+                                         cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001));
+        CvSVM svm;
+        svm.train(training_data, training_classifications, Mat(), Mat(), params);
+        for (int i = 0; i < testing_data.rows; i++)
+        {
+            results.at<float>(i, 0) = svm.predict(testing_data.row(i));
+        }
+        break;
+    }
+    case KNN:
+    {
+        CvKNearest knn(training_data, training_classifications, Mat(), false, (int) values[0]);
+        Mat neighbour_responses, dists;
+        knn.find_nearest(testing_data, (int) values[0], results, neighbour_responses, dists);
+        break;
+    }
+    case RANDOM_FOREST:
+    {
+        Mat var_type = Mat(training_data.cols + 1, 1, CV_8U);
+        var_type.setTo(Scalar(CV_VAR_NUMERICAL));
+        var_type.at<uchar>(training_data.cols, 0) = CV_VAR_CATEGORICAL;
+
+        CvRTParams params = CvRTParams((int) values[0], 5, 0, false, 15, NULL, false,
+                                       MIN((int) values[1], training_data.cols),
+                                       (int) values[2], 0.01f,
+                                       CV_TERMCRIT_ITER | CV_TERMCRIT_EPS);
+        CvRTrees forest;
+        forest.train(training_data, CV_ROW_SAMPLE, training_classifications,
+                     Mat(), Mat(), var_type, Mat(), params);
+        for (int i = 0; i < testing_data.rows; i++)
+        {
+            results.at<float>(i, 0) = forest.predict(testing_data.row(i), Mat());
+        }
+        break;
+    }
+    case NEURAL_NETWORK:
+    {
+        Mat outputs = Mat::zeros(training_data.rows, NUMBER_OF_CLASSES, CV_32FC1);
+        for (int i = 0; i < training_data.rows; i++)
+        {
+            outputs.at<float>(i, (int) training_classifications.at<float>(i, 0)) = 1.0;
+        }
+
+        Mat layers = Mat(1, 3, CV_32SC1);
+        layers.at<int>(0, 0) = training_data.cols;
+        layers.at<int>(0, 1) = (int) values[0];
+        layers.at<int>(0, 2) = NUMBER_OF_CLASSES;
+
+        CvANN_MLP nnetwork;
+        nnetwork.create(layers, CvANN_MLP::SIGMOID_SYM, 0.6, 1);
+        nnetwork.train(training_data, outputs, Mat(), Mat(),
+                       CvANN_MLP_TrainParams(cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 500, 0.000001),
+                                             CvANN_MLP_TrainParams::BACKPROP, values[1], 0.1));
+
+        Mat classification_result = Mat(1, NUMBER_OF_CLASSES, CV_32FC1);
+        for (int i = 0; i < testing_data.rows; i++)
+        {
+            Point max_loc;
+            nnetwork.predict(testing_data.row(i), classification_result);
+            minMaxLoc(classification_result, 0, 0, 0, &max_loc);
+            results.at<float>(i, 0) = (float) max_loc.x;
+        }
+        break;
+    }
+    }
+
+    int correct = 0;
+    for (int i = 0; i < testing_data.rows; i++)
+    {
+        if (fabs(results.at<float>(i, 0) - testing_classifications.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct++;
+        }
+    }
+
+    return (double) correct / testing_data.rows;
+}
+
+// the attributes of a feature mask
+
+static FeatureSelector mask_selector(const std::vector<uchar>& features)
+{
+    std::vector<int> columns;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        if (features[i])
+        {
+            columns.push_back((int) i);
+        }
+    }
+
+    FeatureSelector selector;
+    selector.select_columns(columns, (int) features.size());
+    return selector;
+}
+
+static void print_values(const std::vector<GeneRange>& ranges, const std::vector<double>& values)
+{
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        printf("%s%s = %g", (i > 0) ? ", " : "", ranges[i].name, values[i]);
+    }
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 4)
+    {
+        printf("usage: %s {svm|knn|rtrees|mlp} training_data_file testing_data_file [generations]\n",
+               argv[0]);
+        return -1;
+    }
+
+    Classifier classifier;
+    if (!strcmp(argv[1], "svm"))
+    {
+        classifier = SVM_RBF;
+    }
+    else if (!strcmp(argv[1], "knn"))
+    {
+        classifier = KNN;
+    }
+    else if (!strcmp(argv[1], "rtrees"))
+    {
+        classifier = RANDOM_FOREST;
+    }
+    else if (!strcmp(argv[1], "mlp"))
+    {
+        classifier = NEURAL_NETWORK;
+    }
+    else
+    {
+        printf("ERROR: unknown classifier %s\n", argv[1]);
+        return -1;
+    }
+
+    Mat training_data, training_classifications;
+    Mat testing_data, testing_classifications;
+
+    if (read_data_from_csv(argv[2], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[3], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        // hold out the last of the training samples for validation
+
+        int n_fit = NUMBER_OF_TRAINING_SAMPLES - VALIDATION_SAMPLES;
+        Mat fit_data = training_data.rowRange(0, n_fit);
+        Mat fit_classifications = training_classifications.rowRange(0, n_fit);
+        Mat validation_data = training_data.rowRange(n_fit, NUMBER_OF_TRAINING_SAMPLES);
+        Mat validation_classifications = training_classifications.rowRange(n_fit, NUMBER_OF_TRAINING_SAMPLES);
+
+        std::vector<double> defaults;
+        std::vector<GeneRange> ranges = hyperparameters(classifier, defaults);
+
+        // fitness : validation accuracy on the selected attributes, less the
+        // cost of the attributes used
+
+        GeneticOptimizer::Fitness fitness =
+            [&](const std::vector<double>& values, const std::vector<uchar>& features)
+        {
+            FeatureSelector selector = mask_selector(features);
+
+            double accuracy = train_and_test(classifier, values,
+                                             selector.transform(fit_data), fit_classifications,
+                                             selector.transform(validation_data),
+                                             validation_classifications);
+
+            return accuracy - FEATURE_COST * selector.selected();
+        };
+
+        GeneticParams params;
+        params.generations = (argc > 4) ? atoi(argv[4]) : DEFAULT_GENERATIONS;
+
+        GeneticOptimizer ga(ranges, ATTRIBUTES_PER_SAMPLE, fitness, params);
+
+        printf( "\nUsing training database: %s (%d for validation)\n", argv[2], VALIDATION_SAMPLES);
+        printf( "Using testing database: %s\n", argv[3]);
+        printf( "Population %d, %d generations, %d threads\n\n", params.population,
+                params.generations, ThreadPool::global().thread_count());
+
+        int64 start = getTickCount();
+
+        Genome best = ga.run([&](int generation, const Genome& genome)
+        {
+            FeatureSelector selector = mask_selector(genome.features);
+
+            printf("generation %3d : fitness %.4f (", generation, genome.fitness);
+            print_values(ranges, ga.values(genome));
+            printf(", %d attributes)\n", selector.selected());
+            fflush(NULL);
+        });
+
+        double search_time = (getTickCount() - start) / getTickFrequency();
+
+        printf("\nSearch time %g s : %d genomes trained, %d answered from the cache\n",
+               search_time, ga.evaluations(), ga.cache_hits());
+
+        // retrain the best on all of the training data and test it against the
+        // defaults
+
+        FeatureSelector selector = mask_selector(best.features);
+        std::vector<double> values = ga.values(best);
+
+        double best_accuracy = train_and_test(classifier, values,
+                                              selector.transform(training_data), training_classifications,
+                                              selector.transform(testing_data), testing_classifications);
+        double default_accuracy = train_and_test(classifier, defaults,
+                                  training_data, training_classifications,
+                                  testing_data, testing_classifications);
+
+        printf("\nResults on the testing database: %s\n", argv[3]);
+        printf("\tdefaults (");
+        print_values(ranges, defaults);
+        printf(", %d attributes) : %.2f%%\n", ATTRIBUTES_PER_SAMPLE, default_accuracy * 100);
+        printf("\tGA best  (");
+        print_values(ranges, values);
+        printf(", %d attributes) : %.2f%%\n", selector.selected(), best_accuracy * 100);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
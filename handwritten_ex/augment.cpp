@@ -0,0 +1,278 @@
+// Example : neural network (MLP) and decision tree ensemble learning from
+// lazily augmented (randomly shifted / rotated) digit images
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : handwritten_ex
+
+// Every epoch the network is trained on (and a new tree of the ensemble is
+// grown from) a freshly transformed copy of the training images, generated
+// in the background on the thread pool while the previous epoch is being
+// used - the expanded training set (epochs x samples) is never stored.
+// The network is trained one epoch at a time by continuing from its current
+// weights (CvANN_MLP::UPDATE_WEIGHTS); the trees vote on the classification.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "augment.h"
+
+#include <vector>
+using namespace std;
+
+#include <stdio.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 797
+#define ATTRIBUTES_PER_SAMPLE 256
+#define NUMBER_OF_TESTING_SAMPLES 796
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define IMAGE_SIZE 16           // samples are 16x16 binary images
+
+#define USE_AUGMENTATION 1      // set to 0 to train on the original images every epoch
+#define MAX_SHIFT 1             // pixels (in x and y)
+#define MAX_ROTATION 10         // degrees (either way)
+
+#define NUMBER_OF_EPOCHS 50     // (one tree of the ensemble is grown per epoch)
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+
+    int classlabel; // the class label
+    float tmpf;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 256 elements (0-255) in each line are the attributes
+
+                fscanf(f, "%f,", &tmpf);
+                data.at<float>(line, attribute) = tmpf;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 256 is the class label {0 ... 9}
+
+                fscanf(f, "%i,", &classlabel);
+                classes.at<float>(line, classlabel) = 1.0;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat::zeros(NUMBER_OF_TRAINING_SAMPLES, NUMBER_OF_CLASSES, CV_32FC1);
+
+    // define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat::zeros(NUMBER_OF_TESTING_SAMPLES, NUMBER_OF_CLASSES, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        // the trees need the class labels themselves rather than the
+        // {0,0 ... 1,0,0} vectors used for the network
+
+        Mat training_labels = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+        for (int tsample = 0; tsample < NUMBER_OF_TRAINING_SAMPLES; tsample++)
+        {
+            Point max_loc;
+            minMaxLoc(training_classifications.row(tsample), 0, 0, 0, &max_loc);
+            training_labels.at<float>(tsample, 0) = (float) max_loc.x;
+        }
+
+        // network 3 layer 256->10->10 (as neuralnetwork.cpp), trained one
+        // epoch (i.e. one iteration of backpropagation) at a time
+
+        Mat layers = Mat(1,3,CV_32SC1);
+        layers.at<int>(0,0) = ATTRIBUTES_PER_SAMPLE;
+        layers.at<int>(0,1) = 10;
+        layers.at<int>(0,2) = NUMBER_OF_CLASSES;
+
+        CvANN_MLP* nnetwork = new CvANN_MLP;
+        nnetwork->create(layers, CvANN_MLP::SIGMOID_SYM, 0.6, 1);
+
+        CvANN_MLP_TrainParams nn_params = CvANN_MLP_TrainParams(
+                                              cvTermCriteria(CV_TERMCRIT_ITER, 1, 0),
+                                              CvANN_MLP_TrainParams::BACKPROP,
+                                              0.1,
+                                              0.1);
+
+        // decision trees (all attributes numerical, class categorical)
+
+        Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+        var_type.setTo(Scalar(CV_VAR_NUMERICAL) );
+        var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+        CvDTreeParams tree_params = CvDTreeParams(25, // max depth
+                                    5, // min sample count
+                                    0, // regression accuracy: N/A here
+                                    false, // compute surrogate split, no missing data
+                                    15, // max number of categories (use sub-optimal algorithm for larger numbers)
+                                    0, // the number of cross-validation folds (no pruning)
+                                    false, // use 1SE rule => smaller tree
+                                    false, // throw away the pruned tree branches
+                                    NULL // the array of priors
+                                                 );
+
+        vector<CvDTree*> trees;
+
+        // train, epoch by epoch
+
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Augmentation %s (shift up to %d pixels, rotation up to %d degrees)\n",
+                USE_AUGMENTATION ? "on" : "off", MAX_SHIFT, MAX_ROTATION);
+
+#if (USE_AUGMENTATION)
+        ImageAugmenter augmenter(IMAGE_SIZE, MAX_SHIFT, MAX_ROTATION);
+        AugmentedEpochs epochs(training_data, augmenter);
+#endif
+
+        int64 start = getTickCount();
+        for (int epoch = 0; epoch < NUMBER_OF_EPOCHS; epoch++)
+        {
+#if (USE_AUGMENTATION)
+            const Mat& epoch_data = epochs.next();
+#else
+            const Mat& epoch_data = training_data;
+#endif
+            nnetwork->train(epoch_data, training_classifications, Mat(), Mat(), nn_params,
+                            (epoch > 0) ? CvANN_MLP::UPDATE_WEIGHTS : 0);
+
+            CvDTree* dtree = new CvDTree;
+            dtree->train(epoch_data, CV_ROW_SAMPLE, training_labels,
+                         Mat(), Mat(), var_type, Mat(), tree_params);
+            trees.push_back(dtree);
+        }
+        printf( "Training time : %g s for %d epochs (%d training samples seen, at most %d held)\n",
+                (getTickCount() - start) / getTickFrequency(), NUMBER_OF_EPOCHS,
+                NUMBER_OF_EPOCHS * NUMBER_OF_TRAINING_SAMPLES,
+                (USE_AUGMENTATION ? 3 : 1) * NUMBER_OF_TRAINING_SAMPLES);
+
+        // perform classifier testing and report results
+
+        Mat test_sample;
+        Mat classificationResult = Mat(1, NUMBER_OF_CLASSES, CV_32FC1);
+        Point max_loc = Point(0,0);
+        int nn_correct = 0;
+        int tree_correct = 0;
+
+        printf( "\nUsing testing database: %s\n\n", argv[2]);
+
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+
+            // extract a row from the testing matrix
+
+            test_sample = testing_data.row(tsample);
+
+            // run neural network prediction (the class with the highest "probability")
+
+            nnetwork->predict(test_sample, classificationResult);
+            minMaxLoc(classificationResult, 0, 0, 0, &max_loc);
+
+            if (testing_classifications.at<float>(tsample, max_loc.x))
+            {
+                nn_correct++;
+            }
+
+            // run the tree ensemble (majority vote)
+
+            int votes[NUMBER_OF_CLASSES] = {0,0,0,0,0,0,0,0,0,0};
+            for (size_t t = 0; t < trees.size(); t++)
+            {
+                votes[(int) trees[t]->predict(test_sample, Mat(), false)->value]++;
+            }
+
+            int result = 0;
+            for (int c = 1; c < NUMBER_OF_CLASSES; c++)
+            {
+                if (votes[c] > votes[result])
+                {
+                    result = c;
+                }
+            }
+
+            if (testing_classifications.at<float>(tsample, result))
+            {
+                tree_correct++;
+            }
+        }
+
+        printf( "\nResults on the testing database: %s\n"
+                "\tNeural network correct classification: %d (%g%%)\n"
+                "\tTree ensemble (%d trees) correct classification: %d (%g%%)\n",
+                argv[2],
+                nn_correct, (double) nn_correct*100/NUMBER_OF_TESTING_SAMPLES,
+                (int) trees.size(),
+                tree_correct, (double) tree_correct*100/NUMBER_OF_TESTING_SAMPLES);
+
+        for (size_t t = 0; t < trees.size(); t++)
+        {
+            delete trees[t];
+        }
+        delete nnetwork;
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
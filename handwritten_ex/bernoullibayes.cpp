@@ -0,0 +1,284 @@
+// Example : Bernoulli naive Bayes for binary attributes (popcount scoring)
+// usage: prog training_data_file testing_data_file [repeats]
+
+// For use with test / training datasets : handwritten_ex
+
+// The semeion attributes are binary pixels (0 or 1), yet a normal Bayes
+// classifier models each as a normal distribution. A Bernoulli naive Bayes
+// classifier (see common/bernoulli_bayes.h) instead models each pixel as
+// on with some probability per class; the samples are packed into bits (256
+// pixels = four 64-bit words, rather than 1KB of floats) and scored with
+// bitwise AND and population count against 8-bit quantised per class
+// weights. This compares the accuracy and the prediction time per sample of
+// the Gaussian models (OpenCV's full covariance model, and the diagonal one
+// of common/naive_bayes.h) with the Bernoulli model scored exactly and by
+// popcount, one sample at a time and on the whole (packed) testing set.
+// Each prediction pass is repeated [repeats] times (default 100).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "bernoulli_bayes.h"
+#include "naive_bayes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+#define NUMBER_OF_TRAINING_SAMPLES 797
+#define ATTRIBUTES_PER_SAMPLE 256
+#define NUMBER_OF_TESTING_SAMPLES 796
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define DEFAULT_REPEATS 100
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmpf;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 256 elements (0-255) in each line are the attributes
+
+                fscanf(f, "%f,", &tmpf);
+                data.at<float>(line, attribute) = tmpf;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 256 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmpf);
+                classes.at<float>(line, 0) = tmpf;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// report the accuracy of results (a column of predicted classes) and the
+// prediction time per sample (seconds taken over repeats passes)
+
+void report(const char* name, const Mat& results, const Mat& classes,
+            double seconds, int repeats)
+{
+    int correct_class = 0;
+    for (int i = 0; i < classes.rows; i++)
+    {
+        if (fabs(results.at<float>(i, 0) - classes.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+
+    printf("%-36s %8.2f%% %14.3f\n", name,
+           (double) correct_class * 100 / classes.rows,
+           seconds * 1e6 / ((double) repeats * classes.rows));
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [repeats]\n", argv[0]);
+        return -1;
+    }
+
+    int repeats = (argc > 3) ? MAX(1, atoi(argv[3])) : DEFAULT_REPEATS;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data =
+        Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data =
+        Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications =
+        Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s (%d repeats)\n\n", argv[2], repeats);
+
+        // train the Gaussian models and the Bernoulli model
+
+        CvNormalBayesClassifier normal_bayes;
+        normal_bayes.train(training_data, training_classifications, Mat(), Mat(), false);
+
+        GaussianNaiveBayes gaussian_bayes;
+        gaussian_bayes.train(training_data, training_classifications);
+
+        BernoulliNaiveBayes bernoulli_bayes;
+        bernoulli_bayes.train(training_data, training_classifications);
+
+        // the testing set packed into bits
+
+        Mat packed;
+        bernoulli_bayes.pack(testing_data, packed);
+
+        printf("Testing set : %d bytes as floats, %d bytes packed\n\n",
+               (int) (testing_data.total() * testing_data.elemSize()),
+               (int) (packed.total() * packed.elemSize()));
+
+        printf("%-36s %9s %14s\n", "model", "accuracy", "us / sample");
+
+        Mat results(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+        Mat exact_results(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+        int64 start;
+
+        // Gaussian, full covariance (OpenCV)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) = normal_bayes.predict(testing_data.row(tsample));
+            }
+        }
+        report("Gaussian, full covariance", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // Gaussian, diagonal covariance
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) = gaussian_bayes.predict(testing_data.ptr<float>(tsample));
+            }
+        }
+        report("Gaussian, diagonal covariance", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // Bernoulli, exact weights (packed samples)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                exact_results.at<float>(tsample, 0) =
+                    bernoulli_bayes.predict_exact((const uint64*) packed.ptr(tsample));
+            }
+        }
+        report("Bernoulli, exact", exact_results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // Bernoulli, popcount (each sample packed as it is classified)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) = bernoulli_bayes.predict(testing_data.ptr<float>(tsample));
+            }
+        }
+        report("Bernoulli, popcount (pack + score)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // Bernoulli, popcount (packed samples)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) =
+                    bernoulli_bayes.predict_packed((const uint64*) packed.ptr(tsample));
+            }
+        }
+        report("Bernoulli, popcount (packed)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // how many classifications the quantisation of the weights changed
+
+        int differences = 0;
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            if (results.at<float>(tsample, 0) != exact_results.at<float>(tsample, 0))
+            {
+                differences++;
+            }
+        }
+
+        // Bernoulli, popcount (whole packed testing set)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            bernoulli_bayes.predict_packed(packed, results);
+        }
+        report("Bernoulli, popcount (batch)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        printf("\nPopcount and exact Bernoulli classes differ for %d of %d samples\n",
+               differences, NUMBER_OF_TESTING_SAMPLES);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
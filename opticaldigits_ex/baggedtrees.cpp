@@ -0,0 +1,303 @@
+// Example : bagged decision trees trained from one shared presorted index
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : opticaldigits_ex
+
+// Training a decision tree starts by sorting the samples on every (ordered)
+// attribute; for an ensemble of trees over the same data that work is the
+// same for every tree. Here a bag of decision trees is trained twice :
+
+//  + rebuilt : each tree is trained from a matrix of the samples of its bag,
+//    so the 64 attribute orderings are re-derived every time
+
+//  + shared : the training data (CvDTreeTrainData, with the attribute
+//    orderings) is built once after loading and shared read-only by every
+//    tree, which is trained with only its bag (CvDTree::train(data,
+//    subsample_idx)) - the presorted orderings are just filtered by bag
+//    membership
+
+// The bags (drawn with replacement) are the same for both, so the trees -
+// and their predictions - are the same (up to the order in which tied
+// attribute values are split); only the training time differs.
+// N.B. CvRTrees and CvBoost already train all of their trees / rounds from a
+// single shared CvDTreeTrainData in this way (see randomforest.cpp and
+// boosttree.cpp).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include <stdio.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define NUMBER_OF_TREES 50      // in the bag
+#define BAG_SEED 0x12345678     // for drawing the bags
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// majority vote of the trees for each testing sample, returning the number
+// classified correctly
+
+static int test_trees(CvDTree** trees, const Mat& testing_data,
+                      const Mat& testing_classifications, Mat& results)
+{
+    int correct_class = 0;
+
+    results = Mat(testing_data.rows, 1, CV_32FC1);
+
+    for (int tsample = 0; tsample < testing_data.rows; tsample++)
+    {
+        int votes[NUMBER_OF_CLASSES] = {0,0,0,0,0,0,0,0,0,0};
+        int best_class = 0;
+
+        for (int t = 0; t < NUMBER_OF_TREES; t++)
+        {
+            int result = (int) trees[t]->predict(testing_data.row(tsample))->value;
+            votes[result]++;
+            if (votes[result] > votes[best_class])
+            {
+                best_class = result;
+            }
+        }
+
+        results.at<float>(tsample, 0) = (float) best_class;
+
+        // (N.B. openCV uses a floating point decision tree implementation!)
+
+        if (fabs(((float) best_class) - testing_classifications.at<float>(tsample, 0))
+                < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+
+    return correct_class;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // define all the attributes as numerical and the class as categorical
+
+    Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+    var_type.setTo(Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
+    var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        // parameters of each (unpruned) tree of the bag
+
+        CvDTreeParams params = CvDTreeParams(25, // max depth
+                                             5, // min sample count
+                                             0, // regression accuracy: N/A here
+                                             false, // compute surrogate split, no missing data
+                                             15, // max number of categories
+                                             0, // no cross-validation folds (no pruning)
+                                             false, // use 1SE rule => smaller tree
+                                             false, // throw away the pruned tree branches
+                                             NULL // the array of priors (equal)
+                                            );
+
+        // draw the bags : NUMBER_OF_TRAINING_SAMPLES samples with replacement
+
+        RNG rng(BAG_SEED);
+        Mat bags = Mat(NUMBER_OF_TREES, NUMBER_OF_TRAINING_SAMPLES, CV_32SC1);
+        for (int t = 0; t < NUMBER_OF_TREES; t++)
+        {
+            for (int i = 0; i < NUMBER_OF_TRAINING_SAMPLES; i++)
+            {
+                bags.at<int>(t, i) = rng.uniform(0, NUMBER_OF_TRAINING_SAMPLES);
+            }
+        }
+
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n\n", argv[2]);
+
+        CvDTree* rebuilt_trees[NUMBER_OF_TREES];
+        CvDTree* shared_trees[NUMBER_OF_TREES];
+
+        // 1. rebuilt : every tree trained from the matrices
+
+        int64 start = getTickCount();
+
+        Mat bag_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+        Mat bag_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+        for (int t = 0; t < NUMBER_OF_TREES; t++)
+        {
+            // (a sample index may not repeat samples, so the bag is copied out)
+
+            for (int i = 0; i < NUMBER_OF_TRAINING_SAMPLES; i++)
+            {
+                Mat row = bag_data.row(i);
+                training_data.row(bags.at<int>(t, i)).copyTo(row);
+                bag_classifications.at<float>(i, 0) =
+                    training_classifications.at<float>(bags.at<int>(t, i), 0);
+            }
+
+            rebuilt_trees[t] = new CvDTree;
+            rebuilt_trees[t]->train(bag_data, CV_ROW_SAMPLE, bag_classifications,
+                                    Mat(), Mat(), var_type, Mat(), params);
+        }
+
+        double rebuilt_time = (getTickCount() - start) / getTickFrequency();
+
+        // 2. shared : the training data (presorted attributes) is built once
+
+        start = getTickCount();
+
+        CvMat data_mat = training_data;
+        CvMat classes_mat = training_classifications;
+        CvMat var_type_mat = var_type;
+
+        CvDTreeTrainData* shared_data =
+            new CvDTreeTrainData(&data_mat, CV_ROW_SAMPLE, &classes_mat, 0, 0,
+                                 &var_type_mat, 0, params,
+                                 true,   // shared between trees
+                                 false);
+
+        double index_time = (getTickCount() - start) / getTickFrequency();
+
+        start = getTickCount();
+
+        for (int t = 0; t < NUMBER_OF_TREES; t++)
+        {
+            Mat bag = bags.row(t);
+            CvMat bag_mat = bag;
+
+            shared_trees[t] = new CvDTree;
+            shared_trees[t]->train(shared_data, &bag_mat);
+        }
+
+        double shared_time = (getTickCount() - start) / getTickFrequency();
+
+        // test both bags
+
+        Mat rebuilt_results, shared_results;
+        int rebuilt_correct = test_trees(rebuilt_trees, testing_data,
+                                         testing_classifications, rebuilt_results);
+        int shared_correct = test_trees(shared_trees, testing_data,
+                                        testing_classifications, shared_results);
+
+        int agree = 0;
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            agree += (rebuilt_results.at<float>(tsample, 0) == shared_results.at<float>(tsample, 0));
+        }
+
+        printf("%-8s  %14s  %14s  %9s\n", "trees", "index time (s)", "train time (s)", "correct");
+        printf("%-8s  %14s  %14.3f  %8.2f%%\n", "rebuilt", "-", rebuilt_time,
+               (double) rebuilt_correct * 100 / NUMBER_OF_TESTING_SAMPLES);
+        printf("%-8s  %14.3f  %14.3f  %8.2f%%\n", "shared", index_time, shared_time,
+               (double) shared_correct * 100 / NUMBER_OF_TESTING_SAMPLES);
+
+        printf("\n%d trees, agreement between the two bags %g%%\n", NUMBER_OF_TREES,
+               (double) agree * 100 / NUMBER_OF_TESTING_SAMPLES);
+
+        // N.B. the trees must go before the training data they share
+
+        for (int t = 0; t < NUMBER_OF_TREES; t++)
+        {
+            delete rebuilt_trees[t];
+            delete shared_trees[t];
+        }
+        delete shared_data;
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
@@ -13,6 +13,8 @@
 
 using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
+#include "sample_weights.h"
+
 #include <stdio.h>
 
 /******************************************************************************/
@@ -26,6 +28,12 @@ using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
 // N.B. classes are integer handwritten digits in range 0-9
 
+// weight the two (binary) classes of the "unrolled" data equally - otherwise
+// the priors are the class counts (9:1, as the data is) and the boosted
+// trees are left to favour the majority (0, wrong class) response
+
+#define USE_CLASS_BALANCING 0  // set to 1 for equally weighted classes
+
 /******************************************************************************/
 
 // loads the sample database from file (which is a CSV text file)
@@ -181,9 +189,20 @@ int main( int argc, char** argv )
 
         // weights of each classification for classes
         // N.B. in the "unrolled" data we have an imbalance in the training examples
+        // (NUMBER_OF_CLASSES - 1 : 1) - rather than duplicating the rarer samples
+        // the priors (total weight of each class) are computed from the data
+
+        Mat unrolled_classes;
+        new_responses.convertTo(unrolled_classes, CV_32F);
+
+        ClassWeights class_weights;
+        class_weights.fit(unrolled_classes, Mat(), USE_CLASS_BALANCING);
+        std::vector<float> priors = class_weights.priors();
 
-        float priors[] = {( NUMBER_OF_CLASSES - 1),1};
-        //float priors[] = {1,1};
+#if (USE_CLASS_BALANCING)
+        printf( "Class priors : %g (wrong class), %g (correct class)\n",
+                priors[0], priors[1]);
+#endif
 
         // set the boost parameters
 
@@ -199,7 +218,7 @@ int main( int argc, char** argv )
 
                                              25, 	  // max depth of trees
                                              false,  // compute surrogate split, no missing data
-                                             priors );
+                                             &priors[0] );
 
         // as CvBoostParams inherits from CvDTreeParams we can also set generic
         // parameters of decision trees too (otherwise they use the defaults)
@@ -0,0 +1,338 @@
+// Example : tree training from a column-major (attribute per row) copy of the
+// training data, benchmarked against the usual row-major (sample per row) data
+// usage: prog training_data_file testing_data_file [repeats]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// The tree based learners (decision tree, random forest, boosted trees)
+// work an attribute at a time - each attribute's values over all of the
+// samples are gathered and sorted before the split search - whereas
+// read_data_from_csv stores a sample per row, so those values are a row
+// stride apart. Here the loader can also fill a column-major copy (one row per
+// attribute) as it reads the file, and the trainers are given it with
+// CV_COL_SAMPLE so that each attribute is read contiguously. The decision
+// and boosted trees learnt are the same either way (so are the testing
+// results; the random forest differs only by its random draws), only the
+// training time differs. N.B. OpenCV presorts the attributes into its own
+// buffers once per training call, so only that initial pass benefits.
+
+// Boosted trees in OpenCV are 2-class only, so they are trained here to
+// recognise one digit (BOOST_DIGIT) from all of the others.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define DEFAULT_REPEATS 5   // times each classifier is trained (best time kept)
+#define BOOST_DIGIT 0       // digit recognised by the boosted trees
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+// (if columns is given it is also filled with a column-major copy of the
+// data : attribute a of sample s at row a, column s)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples, Mat* columns)
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    if (columns)
+    {
+        *columns = Mat(ATTRIBUTES_PER_SAMPLE, n_samples, CV_32FC1);
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+                if (columns)
+                {
+                    columns->at<float>(attribute, line) = tmp;
+                }
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// the classifiers compared - each trained from data with the given layout
+// (CV_ROW_SAMPLE or CV_COL_SAMPLE)
+
+static void train_tree(CvDTree& tree, const Mat& data, int tflag,
+                       const Mat& classes, const Mat& var_type)
+{
+    CvDTreeParams params = CvDTreeParams(25, // max depth
+                                         5, // min sample count
+                                         0, // regression accuracy: N/A here
+                                         false, // compute surrogate split, no missing data
+                                         15, // max number of categories
+                                         10, // the number of cross-validation folds
+                                         true, // use 1SE rule => smaller tree
+                                         true, // throw away the pruned tree branches
+                                         NULL // the array of priors (equal)
+                                        );
+
+    tree.train(data, tflag, classes, Mat(), Mat(), var_type, Mat(), params);
+}
+
+static void train_forest(CvRTrees& forest, const Mat& data, int tflag,
+                         const Mat& classes, const Mat& var_type)
+{
+    CvRTParams params = CvRTParams(25, // max depth
+                                   5, // min sample count
+                                   0, // regression accuracy: N/A here
+                                   false, // compute surrogate split, no missing data
+                                   15, // max number of categories
+                                   NULL, // the array of priors (equal)
+                                   false,  // calculate variable importance
+                                   4,       // number of variables randomly selected at each node
+                                   100,	 // max number of trees in the forest
+                                   0.01f,				// forrest accuracy
+                                   CV_TERMCRIT_ITER |	CV_TERMCRIT_EPS // termination cirteria
+                                  );
+
+    forest.train(data, tflag, classes, Mat(), Mat(), var_type, Mat(), params);
+}
+
+static void train_boost(CvBoost& boost, const Mat& data, int tflag,
+                        const Mat& classes, const Mat& var_type)
+{
+    CvBoostParams params = CvBoostParams(CvBoost::REAL, // boosting type
+                                         100, // number of weak classifiers
+                                         0.95, // trim rate
+                                         5, // max depth of trees
+                                         false, // compute surrogate split, no missing data
+                                         NULL // the array of priors (equal)
+                                        );
+
+    boost.train(data, tflag, classes, Mat(), Mat(), var_type, Mat(), params);
+}
+
+/******************************************************************************/
+
+// prints a line of results : the best of the training times and the
+// proportion of testing samples classified correctly
+
+static void report(const char* classifier, const char* layout, double time,
+                   double row_time, const Mat& predicted, const Mat& truth)
+{
+    int correct = 0;
+    for (int i = 0; i < truth.rows; i++)
+    {
+        if (fabs(predicted.at<float>(i, 0) - truth.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct++;
+        }
+    }
+
+    printf("%-14s  %-12s  %14.3f  %8.2fx  %8.2f%%\n", classifier, layout, time,
+           row_time / time, (double) correct * 100 / truth.rows);
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [repeats]\n", argv[0]);
+        return -1;
+    }
+
+    int repeats = (argc > 3) ? atoi(argv[3]) : DEFAULT_REPEATS;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications) - and the column-major copy of the attributes
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+    Mat training_columns;
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // define all the attributes as numerical and the class as categorical
+
+    Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+    var_type.setTo(Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
+    var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications,
+                           NUMBER_OF_TRAINING_SAMPLES, &training_columns) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications,
+                               NUMBER_OF_TESTING_SAMPLES, NULL))
+    {
+        // 2-class version of the problem for the boosted trees
+
+        Mat training_binary = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+        Mat testing_binary = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+        for (int i = 0; i < NUMBER_OF_TRAINING_SAMPLES; i++)
+        {
+            training_binary.at<float>(i, 0) =
+                (training_classifications.at<float>(i, 0) == BOOST_DIGIT) ? 1.0f : 0.0f;
+        }
+        for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+        {
+            testing_binary.at<float>(i, 0) =
+                (testing_classifications.at<float>(i, 0) == BOOST_DIGIT) ? 1.0f : 0.0f;
+        }
+
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n", argv[2]);
+        printf( "Best training time of %d\n\n", repeats);
+
+        printf("%-14s  %-12s  %14s  %9s  %9s\n", "classifier", "layout",
+               "train time (s)", "speedup", "correct");
+
+        const char* names[3] = {"decision tree", "random forest", "boosted trees"};
+        const char* layouts[2] = {"row-major", "column-major"};
+        const Mat* layout_data[2] = {&training_data, &training_columns};
+        int layout_flags[2] = {CV_ROW_SAMPLE, CV_COL_SAMPLE};
+
+        Mat predicted = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+        for (int classifier = 0; classifier < 3; classifier++)
+        {
+            double row_time = 0;
+
+            for (int layout = 0; layout < 2; layout++)
+            {
+                double best_time = DBL_MAX;
+
+                for (int r = 0; r < repeats; r++)
+                {
+                    CvDTree tree;
+                    CvRTrees forest;
+                    CvBoost boost;
+
+                    int64 start = getTickCount();
+                    switch (classifier)
+                    {
+                    case 0:
+                        train_tree(tree, *layout_data[layout], layout_flags[layout],
+                                   training_classifications, var_type);
+                        break;
+                    case 1:
+                        train_forest(forest, *layout_data[layout], layout_flags[layout],
+                                     training_classifications, var_type);
+                        break;
+                    default:
+                        train_boost(boost, *layout_data[layout], layout_flags[layout],
+                                    training_binary, var_type);
+                        break;
+                    }
+                    best_time = MIN(best_time, (getTickCount() - start) / getTickFrequency());
+
+                    // test the last one trained (prediction is always from rows)
+
+                    if (r == repeats - 1)
+                    {
+                        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+                        {
+                            Mat test_sample = testing_data.row(tsample);
+                            float result;
+
+                            switch (classifier)
+                            {
+                            case 0:
+                                result = (float) tree.predict(test_sample)->value;
+                                break;
+                            case 1:
+                                result = forest.predict(test_sample, Mat());
+                                break;
+                            default:
+                                result = boost.predict(test_sample);
+                                break;
+                            }
+                            predicted.at<float>(tsample, 0) = result;
+                        }
+                    }
+                }
+
+                if (layout == 0)
+                {
+                    row_time = best_time;
+                }
+
+                report(names[classifier], layouts[layout], best_time, row_time, predicted,
+                       (classifier == 2) ? testing_binary : testing_classifications);
+            }
+        }
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
@@ -0,0 +1,308 @@
+// Example : feature selection by variance and random forest variable
+// importance, comparing SVM, kNN and neural network (MLP) classification on
+// all of the attributes with classification on the selected attributes only
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : opticaldigits_ex
+
+// Many of the 64 optdigits pixels (e.g. the left and right borders) are
+// (near) constant and carry no information. A random forest is trained
+// with variable importance enabled, then every attribute that is constant
+// over the training set or whose importance falls below MIN_IMPORTANCE is
+// dropped, and the data is remapped to a compact matrix of the rest.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "opencv2/core/core_c.h"
+#include "opencv2/ml/ml.hpp"
+using namespace cv;            // OpenCV API is in the C++ "cv" namespace
+
+#include "feature_select.h"
+
+#include <cstdio>
+using namespace std;
+
+/******************************************************************************/
+// global definitions
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10 // digits 0->9
+
+#define MIN_VARIANCE 0          // attributes with no more variance are dropped
+#define MIN_IMPORTANCE 0.005    // ... as are those with less (forest) importance
+                                // (importance sums to 1, so 1/64 on average)
+
+// "self load" data from CSV file in Mat() objects
+// filename = file to load
+// data = training or testing attributes (1 sample per row)
+// responses =  training or testing classes (1 sample per row)
+// n_samples = number of samples in the set
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples );
+
+/******************************************************************************/
+
+// percentage of the testing samples classified correctly
+
+double percent_correct(const Mat& predictions, const Mat& responses)
+{
+    int correct_class = 0;
+    for (int tsample = 0; tsample < predictions.rows; tsample++)
+    {
+        if (fabs(predictions.at<float>(tsample, 0) - responses.at<float>(tsample, 0))
+            < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+    return (double) correct_class * 100 / predictions.rows;
+}
+
+// trains and tests an SVM, kNN and MLP on the given data, printing a line of
+// results for each
+
+void compare_classifiers(const char* name,
+                         const Mat& training_data, const Mat& training_responses,
+                         const Mat& testing_data, const Mat& testing_responses)
+{
+    Mat predictions = Mat(testing_data.rows, 1, CV_32FC1);
+    double train_time, test_time;
+    int64 start;
+
+    // SVM (parameters as the manual settings of svm.cpp)
+
+    CvSVMParams svm_params = CvSVMParams(CvSVM::C_SVC, CvSVM::LINEAR,
+                                         0.0, 0.0, 0.0, 10, 0, 0, NULL,
+                                         cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001));
+    CvSVM svm;
+
+    start = getTickCount();
+    svm.train(training_data, training_responses, Mat(), Mat(), svm_params);
+    train_time = (getTickCount() - start) / getTickFrequency();
+
+    start = getTickCount();
+    for (int tsample = 0; tsample < testing_data.rows; tsample++)
+    {
+        predictions.at<float>(tsample, 0) = svm.predict(testing_data.row(tsample));
+    }
+    test_time = (getTickCount() - start) / getTickFrequency();
+
+    printf("%-9s  SVM  %10d  %14.3f  %13.3f  %8.2f%%\n", name, training_data.cols,
+           train_time, test_time, percent_correct(predictions, testing_responses));
+
+    // kNN (k = 7, as knn.cpp)
+
+    CvKNearest knn;
+
+    start = getTickCount();
+    knn.train(training_data, training_responses, Mat(), false, 32, false);
+    train_time = (getTickCount() - start) / getTickFrequency();
+
+    start = getTickCount();
+    for (int tsample = 0; tsample < testing_data.rows; tsample++)
+    {
+        predictions.at<float>(tsample, 0) = knn.find_nearest(testing_data.row(tsample), 7);
+    }
+    test_time = (getTickCount() - start) / getTickFrequency();
+
+    printf("%-9s  kNN  %10d  %14.3f  %13.3f  %8.2f%%\n", name, training_data.cols,
+           train_time, test_time, percent_correct(predictions, testing_responses));
+
+    // MLP (one hidden layer of 10 nodes, as neuralnetwork.cpp) trained on
+    // 1-of-N encoded classes
+
+    Mat training_classifications = Mat::zeros(training_data.rows, NUMBER_OF_CLASSES, CV_32FC1);
+    for (int tsample = 0; tsample < training_data.rows; tsample++)
+    {
+        training_classifications.at<float>(tsample, (int) training_responses.at<float>(tsample, 0)) = 1.0;
+    }
+
+    Mat layers = Mat(1, 3, CV_32SC1);
+    layers.at<int>(0, 0) = training_data.cols;
+    layers.at<int>(0, 1) = 10;
+    layers.at<int>(0, 2) = NUMBER_OF_CLASSES;
+
+    CvANN_MLP nnetwork;
+    nnetwork.create(layers, CvANN_MLP::SIGMOID_SYM, 0.6, 1);
+
+    CvANN_MLP_TrainParams mlp_params = CvANN_MLP_TrainParams(
+                                           cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001),
+                                           CvANN_MLP_TrainParams::BACKPROP, 0.1, 0.1);
+
+    start = getTickCount();
+    nnetwork.train(training_data, training_classifications, Mat(), Mat(), mlp_params);
+    train_time = (getTickCount() - start) / getTickFrequency();
+
+    Mat classificationResult = Mat(1, NUMBER_OF_CLASSES, CV_32FC1);
+    Point max_loc = Point(0,0);
+
+    start = getTickCount();
+    for (int tsample = 0; tsample < testing_data.rows; tsample++)
+    {
+        nnetwork.predict(testing_data.row(tsample), classificationResult);
+        minMaxLoc(classificationResult, 0, 0, 0, &max_loc);
+        predictions.at<float>(tsample, 0) = (float) max_loc.x;
+    }
+    test_time = (getTickCount() - start) / getTickFrequency();
+
+    printf("%-9s  MLP  %10d  %14.3f  %13.3f  %8.2f%%\n", name, training_data.cols,
+           train_time, test_time, percent_correct(predictions, testing_responses));
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // define data set objects
+
+        Mat training_data;
+        Mat training_responses;
+
+        Mat testing_data;
+        Mat testing_responses;
+
+    // load training and testing data sets (either from command line or *.{test|train} files
+
+    if (((argc > 2) && (!(read_data_from_csv(argv[1],
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv(argv[2],
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES))))
+        ||            (!(read_data_from_csv("optdigits.train",
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv("optdigits.test",
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES)))
+        )
+    {
+        // train a random forest to find the variable importance of each attribute
+
+        Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+        var_type.setTo(Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
+        var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+        CvRTParams params = CvRTParams(25, // max depth
+                                       5, // min sample count
+                                       0, // regression accuracy: N/A here
+                                       false, // compute surrogate split, no missing data
+                                       15, // max number of categories (use sub-optimal algorithm for larger numbers)
+                                       NULL, // the array of priors
+                                       true,  // calculate variable importance
+                                       4,       // number of variables randomly selected at node and used to find the best split(s).
+                                       50,	 // max number of trees in the forest
+                                       0.01f,				// forrest accuracy
+                                       CV_TERMCRIT_ITER |	CV_TERMCRIT_EPS // termination cirteria
+                                      );
+
+        CvRTrees forest;
+
+        int64 start = getTickCount();
+        forest.train(training_data, CV_ROW_SAMPLE, training_responses,
+                     Mat(), Mat(), var_type, Mat(), params);
+        double forest_time = (getTickCount() - start) / getTickFrequency();
+
+        // select the attributes that vary and are of some importance
+
+        FeatureSelector selector;
+        selector.select(training_data, MIN_VARIANCE, forest.getVarImportance(), MIN_IMPORTANCE);
+
+        Mat compact_training_data = selector.transform(training_data);
+        Mat compact_testing_data = selector.transform(testing_data);
+
+        printf("Variable importance from a random forest (%g s) : %d of %d attributes kept\n",
+               forest_time, selector.selected(), selector.input_dims());
+
+        printf("\nDropped attributes (pixel row, column) :");
+        for (int a = 0, k = 0; a < ATTRIBUTES_PER_SAMPLE; a++)
+        {
+            if ((k < selector.selected()) && (selector.columns()[k] == a))
+            {
+                k++;
+                continue;
+            }
+            printf(" (%d,%d)", a / 8, a % 8);
+        }
+        printf("\n");
+
+        // compare the classifiers on all of the attributes and on the selection
+
+        printf("\n%-9s  %-3s  %10s  %14s  %13s  %9s\n", "selection", "",
+               "attributes", "train time (s)", "test time (s)", "correct");
+
+        compare_classifiers("all", training_data, training_responses,
+                            testing_data, testing_responses);
+        compare_classifiers("selected", compact_training_data, training_responses,
+                            compact_testing_data, testing_responses);
+
+        // on MS Windows wait to exit prompt
+        #ifdef WIN32
+            getchar();
+        #endif // WIN32
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    printf("usage: %s filename.train filename.test\n", argv[0]);
+    printf("Failed to load training and testing data from specified files\n");
+    return -1;
+}
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples )
+{
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    responses = Mat(n_samples, 1, CV_32FC1);
+
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 1; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                responses.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 0; // all OK
+}
+
+/******************************************************************************/
@@ -0,0 +1,249 @@
+// Example : kNN accuracy for every k from one neighbour search
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : opticaldigits_ex
+
+// knn.cpp classifies with a fixed k = 7 (of the max_k = 32 the classifier is
+// trained for) and trying another k means searching the whole training set
+// for every testing sample again. As the k nearest neighbours are just the
+// first k of the max_k nearest, here the max_k nearest neighbours of each
+// testing sample are found once (one find_nearest() call for the whole
+// testing set) and the votes for every k = 1 ... max_k are counted from
+// them incrementally - both the plain majority vote (ties to the smallest
+// class, as by CvKNearest) and the distance weighted vote of knn_weighted.cpp
+// (1 / distance^2) - giving the accuracy of each k for the price of one
+// search. The plain vote for k = 7 is checked against find_nearest(k = 7).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define MAX_K 32      // neighbours found for each testing sample
+#define CHECK_K 7     // k checked against find_nearest() (as in knn.cpp)
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// class with the most votes (the first, i.e. smallest, of any tie)
+
+int best_class(const double* votes)
+{
+    int best = 0;
+    for (int c = 1; c < NUMBER_OF_CLASSES; c++)
+    {
+        if (votes[c] > votes[best])
+        {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file\n", argv[0]);
+        return -1;
+    }
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n\n", argv[2]);
+
+        CvKNearest knn;
+        knn.train(training_data, training_classifications, Mat(), false, MAX_K);
+
+        // the MAX_K nearest neighbours (classes and distances, nearest first)
+        // of every testing sample, in one search
+
+        Mat results, neighbour_responses, distances;
+
+        int64 start = getTickCount();
+        knn.find_nearest(testing_data, MAX_K, results, neighbour_responses, distances);
+        double search_time = (getTickCount() - start) / getTickFrequency();
+
+        // votes accumulated neighbour by neighbour : after the k-th neighbour
+        // of a sample the votes are those of k
+
+        int correct[MAX_K + 1] = {0};
+        int weighted_correct[MAX_K + 1] = {0};
+        int check_class[NUMBER_OF_TESTING_SAMPLES];
+
+        start = getTickCount();
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            const float* neighbours = neighbour_responses.ptr<float>(tsample);
+            const float* d = distances.ptr<float>(tsample);
+            int truth = cvRound(testing_classifications.at<float>(tsample, 0));
+
+            double votes[NUMBER_OF_CLASSES] = {0};
+            double weighted_votes[NUMBER_OF_CLASSES] = {0};
+
+            for (int k = 1; k <= MAX_K; k++)
+            {
+                int c = cvRound(neighbours[k - 1]);
+                votes[c] += 1;
+                weighted_votes[c] += 1.0 / ((double) d[k - 1] * d[k - 1] + FLT_EPSILON);
+
+                int plain = best_class(votes);
+                correct[k] += (plain == truth);
+                weighted_correct[k] += (best_class(weighted_votes) == truth);
+
+                if (k == CHECK_K)
+                {
+                    check_class[tsample] = plain;
+                }
+            }
+        }
+        double vote_time = (getTickCount() - start) / getTickFrequency();
+
+        // report the accuracy of each k
+
+        int best_k = 1;
+        int best_weighted_k = 1;
+
+        printf("%4s %10s %10s\n", "k", "plain", "weighted");
+        for (int k = 1; k <= MAX_K; k++)
+        {
+            printf("%4d %9.2f%% %9.2f%%\n", k,
+                   (double) correct[k] * 100 / NUMBER_OF_TESTING_SAMPLES,
+                   (double) weighted_correct[k] * 100 / NUMBER_OF_TESTING_SAMPLES);
+
+            if (correct[k] > correct[best_k])
+            {
+                best_k = k;
+            }
+            if (weighted_correct[k] > weighted_correct[best_weighted_k])
+            {
+                best_weighted_k = k;
+            }
+        }
+
+        printf("\nBest k : %d plain (%.2f%%), %d weighted (%.2f%%)\n",
+               best_k, (double) correct[best_k] * 100 / NUMBER_OF_TESTING_SAMPLES,
+               best_weighted_k,
+               (double) weighted_correct[best_weighted_k] * 100 / NUMBER_OF_TESTING_SAMPLES);
+
+        printf("\nSearch (k = %d) : %.4f s, votes for all %d values of k : %.4f s\n"
+               "(searching again for each k would take about %.4f s)\n",
+               MAX_K, search_time, MAX_K, vote_time, search_time * MAX_K);
+
+        // check : the plain vote for CHECK_K against find_nearest() itself
+
+        knn.find_nearest(testing_data, CHECK_K, &results);
+
+        int differences = 0;
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            if (cvRound(results.at<float>(tsample, 0)) != check_class[tsample])
+            {
+                differences++;
+            }
+        }
+        printf("\nk = %d : %d of %d classes differ from find_nearest(k = %d)\n",
+               CHECK_K, differences, NUMBER_OF_TESTING_SAMPLES, CHECK_K);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
@@ -0,0 +1,275 @@
+// Example : knn digit classification via coroutines awaiting batched prediction
+// usage: prog training_data_file testing_data_file [max_batch] [max_delay_us]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// Every testing sample is handled by its own coroutine (the testing set is
+// repeated to give several thousand concurrent requests) which co_awaits its
+// prediction - no thread is tied up while it waits. The requests are
+// gathered into batches and each batch is classified by a single call to
+// find_nearest() over all of its samples. For comparison the same requests
+// are also classified one find_nearest() call per sample.
+
+// N.B. requires C++20 (coroutines)
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "opencv2/core/core_c.h"
+#include "opencv2/ml/ml.hpp"
+using namespace cv;            // OpenCV API is in the C++ "cv" namespace
+
+#include "async_predict.h"
+
+#include <atomic>
+#include <latch>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+using namespace std;
+
+/******************************************************************************/
+// global definitions
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10 // digits 0->9
+
+#define K 7                     // number of neighbours used for classification
+#define REPEATS 4               // times each testing sample is requested
+#define DEFAULT_MAX_BATCH 256   // max. samples classified per find_nearest() call
+#define DEFAULT_MAX_DELAY_US 2000 // max. time a request waits for its batch to fill
+
+// "self load" data from CSV file in Mat() objects
+// filename = file to load
+// data = training or testing attributes (1 sample per row)
+// responses =  training or testing classes (1 sample per row)
+// n_samples = number of samples in the set
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples );
+
+/******************************************************************************/
+
+// one request : classify a sample, record the result and count it done
+
+DetachedTask classify(BatchedExecutor& executor, Mat sample, float* result,
+                      latch* done)
+{
+    *result = co_await executor.predict(sample);
+    done->count_down();
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // define data set objects
+
+        Mat training_data;
+        Mat training_responses;
+
+        Mat testing_data;
+        Mat testing_responses;
+
+    // load training and testing data sets (either from command line or *.{test|train} files
+
+    if (((argc > 2) && (!(read_data_from_csv(argv[1],
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv(argv[2],
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES))))
+        ||            (!(read_data_from_csv("optdigits.train",
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv("optdigits.test",
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES)))
+        )
+    {
+        // batching set up (optionally from the command line)
+
+        int max_batch = (argc > 3) ? atoi(argv[3]) : DEFAULT_MAX_BATCH;
+        int max_delay_us = (argc > 4) ? atoi(argv[4]) : DEFAULT_MAX_DELAY_US;
+
+        CvKNearest knn; // knn classifier object
+
+        // train kNN classifier (using training data)
+
+        knn.train(training_data, training_responses, Mat(), false, 32, false);
+
+        int n_requests = testing_data.rows * REPEATS;
+        vector<float> results(n_requests);
+
+        // 1. one coroutine per request, awaiting batched kNN classification
+
+        double batched_time;
+        long n_batches;
+        double mean_batch;
+        {
+            // (declared before the executor so that it outlives it - the last
+            // count_down() runs within the executor's batch, which may still
+            // be inside it when done.wait() returns; the executor finishes
+            // and joins its dispatch thread when destroyed)
+
+            latch done(n_requests);
+
+            BatchedExecutor executor(
+                [&knn](const Mat& samples, Mat& batch_results)
+                {
+                    knn.find_nearest(samples, K, &batch_results);
+                },
+                max_batch, max_delay_us);
+
+            int64 start = getTickCount();
+            for (int r = 0; r < n_requests; r++)
+            {
+                classify(executor, testing_data.row(r % testing_data.rows),
+                         &results[r], &done);
+            }
+            done.wait();
+            batched_time = (getTickCount() - start) / getTickFrequency();
+
+            n_batches = executor.batches();
+            mean_batch = executor.mean_batch_size();
+        }
+
+        // 2. for comparison, one find_nearest() call per request
+
+        int disagreements = 0;
+
+        int64 start = getTickCount();
+        for (int r = 0; r < n_requests; r++)
+        {
+            float result = knn.find_nearest(testing_data.row(r % testing_data.rows), K);
+            if (fabs(result - results[r]) >= FLT_EPSILON)
+            {
+                disagreements++;
+            }
+        }
+        double single_time = (getTickCount() - start) / getTickFrequency();
+
+        // perform classifier testing and report results
+
+        int correct_class = 0;
+        int wrong_class = 0;
+        Mat false_positives = Mat::zeros(NUMBER_OF_CLASSES, 1, CV_32S);
+
+        for (int tsample = 0; tsample < testing_data.rows; tsample++)
+        {
+            float result = results[tsample];
+
+            // if the prediction and the (true) testing classification are the same
+            // (within the bounds of floating point error for cross-platfom safety)
+
+            if (fabs(result - testing_responses.at<float>(tsample, 0))
+                >= FLT_EPSILON)
+            {
+                // if they differ more than floating point error => wrong class
+
+                wrong_class++;
+                false_positives.at<int>((int) result, 0)++;
+
+            } else {
+
+                // otherwise correct
+
+                correct_class++;
+            }
+        }
+
+        printf( "\nResults on the testing database: %s\n"
+                "\tCorrect classification: %d (%g%%)\n"
+                "\tWrong classification: %d (%g%%)\n",
+                (argc > 2) ? argv[2] : "optdigits.test",
+                correct_class, (double) correct_class*100/testing_data.rows,
+                wrong_class, (double) wrong_class*100/testing_data.rows);
+
+        for (unsigned int c = 0; c < NUMBER_OF_CLASSES; c++)
+        {
+            printf( "\tClass (digit %i) false positives 	%d (%g%%)\n", c,
+                    false_positives.at<int>(c,0),
+                    (((double) false_positives.at<int>(c,0))*100)
+                                                    /testing_data.rows);
+        }
+
+        printf( "\nBatching (max. batch %d, max. delay %d us) over %d concurrent requests:\n"
+                "\tBatches run: %ld (mean batch size %g)\n"
+                "\tAwaited (batched) prediction: %g s (%g requests/s)\n"
+                "\tOne prediction per call: %g s (%g requests/s)\n"
+                "\tPredictions differing between the two: %d\n",
+                max_batch, max_delay_us, n_requests,
+                n_batches, mean_batch,
+                batched_time, n_requests / batched_time,
+                single_time, n_requests / single_time,
+                disagreements);
+
+        // on MS Windows wait to exit prompt
+        #ifdef WIN32
+            getchar();
+        #endif // WIN32
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    printf("usage: %s filename.train filename.test [max_batch] [max_delay_us]\n", argv[0]);
+    printf("Failed to load training and testing data from specified files\n");
+    return -1;
+}
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples )
+{
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    responses = Mat(n_samples, 1, CV_32FC1);
+
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 1; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                responses.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 0; // all OK
+}
+
+/******************************************************************************/
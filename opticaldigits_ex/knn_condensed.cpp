@@ -0,0 +1,212 @@
+// Example : kNN with a reduced (edited / condensed) training set
+// usage: prog training_data_file testing_data_file [tolerance]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// kNN stores all 3823 training samples and every query is compared with each
+// of them. Here the training set is first reduced (see
+// common/prototype_select.h) by Wilson editing, Hart condensing, or both, and
+// the number of samples stored, the accuracy and the time per query are
+// reported for each reduction against keeping every sample. The last 956
+// training samples are held out as a validation set, on which the most
+// aggressive reduction whose accuracy is within [tolerance] (default 1
+// percentage point) of the full set is then chosen.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "prototype_select.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define NUMBER_OF_VALIDATION_SAMPLES 956  // held out from the training set
+
+#define K_NEAREST 1         // neighbours used to classify
+#define EDIT_K_NEAREST 3    // neighbours used by Wilson editing
+
+#define DEFAULT_TOLERANCE 1.0  // percentage points of validation accuracy
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [tolerance]\n", argv[0]);
+        return -1;
+    }
+
+    double tolerance = (argc > 3) ? atof(argv[3]) : DEFAULT_TOLERANCE;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n\n", argv[2]);
+
+        // split off the validation samples
+
+        int n_train = NUMBER_OF_TRAINING_SAMPLES - NUMBER_OF_VALIDATION_SAMPLES;
+
+        Mat train_data = training_data.rowRange(0, n_train);
+        Mat train_classes = training_classifications.rowRange(0, n_train);
+        Mat validation_data = training_data.rowRange(n_train, NUMBER_OF_TRAINING_SAMPLES);
+        Mat validation_classes = training_classifications.rowRange(n_train, NUMBER_OF_TRAINING_SAMPLES);
+
+        printf("%-20s %8s %10s %10s %10s %14s %9s\n", "training set", "stored",
+               "reduction", "validation", "testing", "us / query", "speedup");
+
+        PrototypeSelector selector;
+        double full_query_time = 0;
+
+        for (int method = PROTOTYPES_ALL; method < PROTOTYPES_METHODS; method++)
+        {
+            selector.apply(method, train_data, train_classes, EDIT_K_NEAREST);
+
+            Mat kept_data, kept_classes;
+            selector.transform(train_data, train_classes, kept_data, kept_classes);
+
+            CvKNearest knn;
+            knn.train(kept_data, kept_classes, Mat(), false, K_NEAREST);
+
+            // classify the testing samples one query at a time
+
+            int correct_class = 0;
+            int64 start = getTickCount();
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                float result = knn.find_nearest(testing_data.row(tsample), K_NEAREST);
+                if (fabs(result - testing_classifications.at<float>(tsample, 0)) < FLT_EPSILON)
+                {
+                    correct_class++;
+                }
+            }
+            double query_time = (getTickCount() - start) / getTickFrequency();
+
+            if (method == PROTOTYPES_ALL)
+            {
+                full_query_time = query_time;
+            }
+
+            double validation = PrototypeSelector::accuracy(kept_data, kept_classes,
+                                validation_data, validation_classes, K_NEAREST);
+
+            printf("%-20s %8d %9.1f%% %9.2f%% %9.2f%% %14.3f %8.2fx\n",
+                   PrototypeSelector::method_name(method), selector.selected(),
+                   100.0 * (1.0 - (double) selector.selected() / n_train),
+                   validation * 100,
+                   (double) correct_class * 100 / NUMBER_OF_TESTING_SAMPLES,
+                   query_time * 1e6 / NUMBER_OF_TESTING_SAMPLES,
+                   full_query_time / query_time);
+        }
+
+        // the most aggressive reduction within tolerance on the validation set
+
+        int method = selector.select(train_data, train_classes, validation_data,
+                                     validation_classes, K_NEAREST, tolerance / 100,
+                                     EDIT_K_NEAREST);
+
+        printf("\nWithin %g%% of the full set's validation accuracy : %s "
+               "(%d of %d samples stored)\n", tolerance,
+               PrototypeSelector::method_name(method), selector.selected(), n_train);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
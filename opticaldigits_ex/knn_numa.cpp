@@ -0,0 +1,355 @@
+// Example : parallel knn digit classification with NUMA aware data placement
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : opticaldigits_ex
+
+// The training set is split into one shard per (pinned) worker thread, each
+// shard allocated on the NUMA node of the thread that searches it, and the
+// testing set is replicated once per node. Every thread finds the k nearest
+// neighbours of every test sample within its own shard and the per-shard
+// candidates are then merged. For comparison the same search is also run
+// with all threads reading the training set where the loader left it.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "opencv2/core/core_c.h"
+#include "opencv2/ml/ml.hpp"
+using namespace cv;            // OpenCV API is in the C++ "cv" namespace
+
+#include "threadpool.h"
+#include "numa_shards.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <cstdio>
+using namespace std;
+
+/******************************************************************************/
+// global definitions
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10 // digits 0->9
+
+#define K 7 // number of neighbours used for classification
+
+// "self load" data from CSV file in Mat() objects
+// filename = file to load
+// data = training or testing attributes (1 sample per row)
+// responses =  training or testing classes (1 sample per row)
+// n_samples = number of samples in the set
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples );
+
+/******************************************************************************/
+
+// a neighbour found by the search : (squared distance, class label)
+
+typedef pair<float, float> Neighbour;
+
+// find the K nearest rows of data (labels in responses) to every row of
+// queries - nearest[q * K ... q * K + K - 1] receives the result for query q
+// (padded with FLT_MAX distances if data has fewer than K rows)
+
+void search_rows(const Mat& data, const Mat& responses, const Mat& queries,
+                 Neighbour* nearest)
+{
+    for (int q = 0; q < queries.rows; q++)
+    {
+        const float* query = queries.ptr<float>(q);
+        Neighbour* best = nearest + (q * K);
+
+        for (int j = 0; j < K; j++)
+        {
+            best[j] = Neighbour(FLT_MAX, -1.0f);
+        }
+
+        for (int r = 0; r < data.rows; r++)
+        {
+            const float* sample = data.ptr<float>(r);
+            float dist = 0;
+            for (int a = 0; a < data.cols; a++)
+            {
+                float d = query[a] - sample[a];
+                dist += d * d;
+            }
+
+            // keep the K best in order (insertion into a short sorted list)
+
+            if (dist < best[K - 1].first)
+            {
+                int j = K - 1;
+                while ((j > 0) && (best[j - 1].first > dist))
+                {
+                    best[j] = best[j - 1];
+                    j--;
+                }
+                best[j] = Neighbour(dist, responses.at<float>(r, 0));
+            }
+        }
+    }
+}
+
+// majority vote of the K nearest (neighbours are visited nearest first, so a
+// tie goes to the class that reached the winning count with nearer samples)
+
+float vote(const Neighbour* nearest)
+{
+    int votes[NUMBER_OF_CLASSES] = {0};
+    float result = nearest[0].second;
+    int most = 0;
+
+    for (int j = 0; j < K; j++)
+    {
+        if (nearest[j].second < 0)
+        {
+            continue;
+        }
+        int c = (int) nearest[j].second;
+        if (++votes[c] > most)
+        {
+            most = votes[c];
+            result = nearest[j].second;
+        }
+    }
+    return result;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // define data set objects
+
+        Mat training_data;
+        Mat training_responses;
+
+        Mat testing_data;
+        Mat testing_responses;
+
+    // load training and testing data sets (either from command line or *.{test|train} files
+
+    if (((argc > 2) && (!(read_data_from_csv(argv[1],
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv(argv[2],
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES))))
+        ||            (!(read_data_from_csv("optdigits.train",
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv("optdigits.test",
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES)))
+        )
+    {
+        // thread pool with every worker pinned to a CPU (so it stays on one node)
+
+        ThreadPool pool(0, true);
+
+        printf("%d threads over %d NUMA node(s)\n", pool.thread_count(), numa_nodes());
+
+        // place the data : training rows sharded per thread, testing set per node
+
+        int64 start = getTickCount();
+
+        RowShards data_shards;
+        RowShards response_shards;
+        NodeReplicas queries;
+
+        data_shards.partition(training_data, pool);
+        response_shards.partition(training_responses, pool);
+        queries.replicate(testing_data, pool);
+
+        double placement_time = (getTickCount() - start) / getTickFrequency();
+
+        for (int s = 0; s < data_shards.count(); s++)
+        {
+            printf("Shard %d : training rows %d - %d on thread %d (node %d)\n", s,
+                   data_shards.first_row(s),
+                   data_shards.first_row(s) + data_shards.rows(s).rows - 1,
+                   data_shards.thread(s), data_shards.node(s));
+        }
+
+        // 1. search each shard on the thread that owns it
+
+        int n_shards = data_shards.count();
+        vector<Neighbour> candidates((size_t) n_shards * testing_data.rows * K);
+
+        start = getTickCount();
+        {
+            TaskGroup group(pool);
+            for (int s = 0; s < n_shards; s++)
+            {
+                group.run_on(data_shards.thread(s), [&, s]()
+                {
+                    search_rows(data_shards.rows(s), response_shards.rows(s),
+                                queries.for_thread(data_shards.thread(s)),
+                                &candidates[(size_t) s * testing_data.rows * K]);
+                });
+            }
+            group.wait();
+        }
+
+        // merge the per-shard candidates into the overall K nearest
+
+        vector<Neighbour> nearest((size_t) testing_data.rows * K);
+        pool.parallel_for(0, testing_data.rows, [&](int begin, int end)
+        {
+            vector<Neighbour> all(n_shards * K);
+            for (int q = begin; q < end; q++)
+            {
+                for (int s = 0; s < n_shards; s++)
+                {
+                    copy(&candidates[((size_t) s * testing_data.rows + q) * K],
+                         &candidates[((size_t) s * testing_data.rows + q) * K] + K,
+                         &all[s * K]);
+                }
+                partial_sort(all.begin(), all.begin() + K, all.end());
+                copy(all.begin(), all.begin() + K, &nearest[(size_t) q * K]);
+            }
+        });
+        double sharded_time = (getTickCount() - start) / getTickFrequency();
+
+        // 2. for comparison, the same search with every thread reading the
+        // training data from wherever the loader put it
+
+        vector<Neighbour> unplaced((size_t) testing_data.rows * K);
+
+        start = getTickCount();
+        pool.parallel_for(0, testing_data.rows, [&](int begin, int end)
+        {
+            search_rows(training_data, training_responses,
+                        testing_data.rowRange(begin, end), &unplaced[(size_t) begin * K]);
+        });
+        double unplaced_time = (getTickCount() - start) / getTickFrequency();
+
+        // perform classifier testing and report results
+
+        int correct_class = 0;
+        int wrong_class = 0;
+        int disagreements = 0;
+        Mat false_positives = Mat::zeros(NUMBER_OF_CLASSES, 1, CV_32S);
+        float result;
+
+        for (int tsample = 0; tsample < testing_data.rows; tsample++)
+        {
+            result = vote(&nearest[(size_t) tsample * K]);
+
+            if (fabs(result - vote(&unplaced[(size_t) tsample * K])) >= FLT_EPSILON)
+            {
+                disagreements++;
+            }
+
+            // if the prediction and the (true) testing classification are the same
+            // (within the bounds of floating point error for cross-platfom safety)
+
+            if (fabs(result - testing_responses.at<float>(tsample, 0))
+                >= FLT_EPSILON)
+            {
+                // if they differ more than floating point error => wrong class
+
+                wrong_class++;
+                false_positives.at<int>((int) result, 0)++;
+
+            } else {
+
+                // otherwise correct
+
+                correct_class++;
+            }
+        }
+
+        printf( "\nResults on the testing database: %s\n"
+                "\tCorrect classification: %d (%g%%)\n"
+                "\tWrong classification: %d (%g%%)\n",
+                (argc > 2) ? argv[2] : "optdigits.test",
+                correct_class, (double) correct_class*100/testing_data.rows,
+                wrong_class, (double) wrong_class*100/testing_data.rows);
+
+        for (unsigned int c = 0; c < NUMBER_OF_CLASSES; c++)
+        {
+            printf( "\tClass (digit %i) false positives 	%d (%g%%)\n", c,
+                    false_positives.at<int>(c,0),
+                    (((double) false_positives.at<int>(c,0))*100)
+                                                    /testing_data.rows);
+        }
+
+        printf( "\nTimings:\n"
+                "\tData placement: %g s\n"
+                "\tSearch (NUMA placed shards): %g s\n"
+                "\tSearch (loader placed data): %g s\n"
+                "\tPredictions differing between the two: %d\n",
+                placement_time, sharded_time, unplaced_time, disagreements);
+
+        // on MS Windows wait to exit prompt
+        #ifdef WIN32
+            getchar();
+        #endif // WIN32
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    printf("usage: %s filename.train filename.test\n", argv[0]);
+    printf("Failed to load training and testing data from specified files\n");
+    return -1;
+}
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples )
+{
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    responses = Mat(n_samples, 1, CV_32FC1);
+
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 1; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                responses.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 0; // all OK
+}
+
+/******************************************************************************/
@@ -0,0 +1,244 @@
+// Example : knn digit classification served under bursty load
+// usage: prog training_data_file testing_data_file [queue_capacity] [shed|block]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// The testing set is submitted to a prediction service in bursts (much
+// faster than kNN can answer them) to show the effect of bounding the
+// request queue : with "shed" excess requests are rejected straight away,
+// with "block" the client is held back until the servers catch up. Either
+// way the time a request spends queued stays bounded.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include "opencv2/core/core_c.h"
+#include "opencv2/ml/ml.hpp"
+using namespace cv;            // OpenCV API is in the C++ "cv" namespace
+
+#include "prediction_service.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+using namespace std;
+
+/******************************************************************************/
+// global definitions
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10 // digits 0->9
+
+#define DEFAULT_QUEUE_CAPACITY 64   // max. requests waiting to be served
+#define NUMBER_OF_SERVERS 2         // threads running the classifier
+#define BURST_SIZE 200              // requests submitted back to back ...
+#define BURST_INTERVAL_MS 20        // ... then a pause before the next burst
+
+// "self load" data from CSV file in Mat() objects
+// filename = file to load
+// data = training or testing attributes (1 sample per row)
+// responses =  training or testing classes (1 sample per row)
+// n_samples = number of samples in the set
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples );
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // define data set objects
+
+        Mat training_data;
+        Mat training_responses;
+
+        Mat testing_data;
+        Mat testing_responses;
+
+    // load training and testing data sets (either from command line or *.{test|train} files
+
+    if (((argc > 2) && (!(read_data_from_csv(argv[1],
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv(argv[2],
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES))))
+        ||            (!(read_data_from_csv("optdigits.train",
+                          training_data, training_responses, NUMBER_OF_TRAINING_SAMPLES))
+                    && !(read_data_from_csv("optdigits.test",
+                          testing_data, testing_responses, NUMBER_OF_TESTING_SAMPLES)))
+        )
+    {
+        // queue set up (optionally from the command line)
+
+        int queue_capacity = (argc > 3) ? atoi(argv[3]) : DEFAULT_QUEUE_CAPACITY;
+        PredictionService::OverloadPolicy policy =
+            ((argc > 4) && (strcmp(argv[4], "block") == 0))
+            ? PredictionService::BLOCK : PredictionService::SHED;
+
+        CvKNearest knn; // knn classifier object
+
+        // train kNN classifier (using training data)
+
+        knn.train(training_data, training_responses, Mat(), false, 32, false);
+
+        // serve kNN classification (for k = 7) from a bounded queue
+
+        PredictionService service(
+            [&knn](const Mat& sample) { return knn.find_nearest(sample, 7); },
+            queue_capacity, policy, NUMBER_OF_SERVERS);
+
+        printf("Serving with queue capacity %d, policy %s, %d server threads\n",
+               queue_capacity, (policy == PredictionService::SHED) ? "shed" : "block",
+               NUMBER_OF_SERVERS);
+
+        // submit the testing set in bursts
+
+        vector< future<float> > results(testing_data.rows);
+        vector<bool> accepted(testing_data.rows, false);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        for (int tsample = 0; tsample < testing_data.rows; tsample++)
+        {
+            accepted[tsample] = service.submit(testing_data.row(tsample), results[tsample]);
+
+            if (((tsample + 1) % BURST_SIZE) == 0)
+            {
+                PredictionServiceStats s = service.stats();
+                printf("After burst %d : queue depth %d, rejected %ld\n",
+                       (tsample + 1) / BURST_SIZE, s.queue_depth, s.rejected);
+
+                this_thread::sleep_for(chrono::milliseconds(BURST_INTERVAL_MS));
+            }
+        }
+
+        // collect the results of all of the requests that were accepted
+
+        int correct_class = 0;
+        int wrong_class = 0;
+        int served = 0;
+        float result;
+
+        for (int tsample = 0; tsample < testing_data.rows; tsample++)
+        {
+            if (!accepted[tsample])
+            {
+                continue;
+            }
+
+            result = results[tsample].get();
+            served++;
+
+            // if the prediction and the (true) testing classification are the same
+            // (within the bounds of floating point error for cross-platfom safety)
+
+            if (fabs(result - testing_responses.at<float>(tsample, 0))
+                >= FLT_EPSILON)
+            {
+                // if they differ more than floating point error => wrong class
+
+                wrong_class++;
+
+            } else {
+
+                // otherwise correct
+
+                correct_class++;
+            }
+        }
+
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        PredictionServiceStats s = service.stats();
+
+        printf( "\nServing statistics:\n"
+                "\tAccepted requests: %ld\n"
+                "\tRejected requests: %ld (%g%%)\n"
+                "\tPeak queue depth: %d\n"
+                "\tTime queued: mean %g ms, max %g ms\n"
+                "\tThroughput: %g requests/s\n",
+                s.accepted, s.rejected, (double) s.rejected*100/testing_data.rows,
+                s.peak_queue_depth, s.mean_wait_ms, s.max_wait_ms,
+                served / elapsed);
+
+        printf( "\nResults on the served requests: %s\n"
+                "\tCorrect classification: %d (%g%%)\n"
+                "\tWrong classification: %d (%g%%)\n",
+                (argc > 2) ? argv[2] : "optdigits.test",
+                correct_class, served ? (double) correct_class*100/served : 0.0,
+                wrong_class, served ? (double) wrong_class*100/served : 0.0);
+
+        // on MS Windows wait to exit prompt
+        #ifdef WIN32
+            getchar();
+        #endif // WIN32
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    printf("usage: %s filename.train filename.test [queue_capacity] [shed|block]\n", argv[0]);
+    printf("Failed to load training and testing data from specified files\n");
+    return -1;
+}
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat &data, Mat &responses, int n_samples )
+{
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    responses = Mat(n_samples, 1, CV_32FC1);
+
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 1; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                responses.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 0; // all OK
+}
+
+/******************************************************************************/
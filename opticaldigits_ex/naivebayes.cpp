@@ -0,0 +1,229 @@
+// Example : diagonal covariance (naive) vs full covariance Gaussian Bayes
+// usage: prog training_data_file testing_data_file [repeats]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// CvNormalBayesClassifier, despite its description, fits a full covariance
+// normal distribution to each class - so scoring a sample costs O(d^2) per
+// class. A true naive Bayes classifier (see common/naive_bayes.h) assumes
+// the attributes independent within each class, keeping only a mean and a
+// variance per attribute, so scoring is O(d) per class (and vectorises
+// simply). This compares the accuracy and the prediction time per sample of
+// the full covariance model (OpenCV one sample at a time, and the batched
+// version of common/normal_bayes.h) with the diagonal model (one sample at a
+// time, and the whole testing set on the thread pool). Each prediction pass
+// is repeated [repeats] times (default 10) for steadier timings.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "naive_bayes.h"
+#include "normal_bayes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define DEFAULT_REPEATS 10
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// report the accuracy of results (a column of predicted classes) and the
+// prediction time per sample (seconds taken over repeats passes)
+
+void report(const char* name, const Mat& results, const Mat& classes,
+            double seconds, int repeats)
+{
+    int correct_class = 0;
+    for (int i = 0; i < classes.rows; i++)
+    {
+        if (fabs(results.at<float>(i, 0) - classes.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+
+    printf("%-32s %8.2f%% %14.3f\n", name,
+           (double) correct_class * 100 / classes.rows,
+           seconds * 1e6 / ((double) repeats * classes.rows));
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [repeats]\n", argv[0]);
+        return -1;
+    }
+
+    int repeats = (argc > 3) ? MAX(1, atoi(argv[3])) : DEFAULT_REPEATS;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s (%d repeats)\n\n", argv[2], repeats);
+
+        // train the full covariance models (OpenCV's, and the batched one)
+        // and the diagonal covariance model
+
+        CvNormalBayesClassifier opencv_bayes;
+        opencv_bayes.train(training_data, training_classifications, Mat(), Mat(), false);
+
+        BatchNormalBayes batch_bayes;
+        batch_bayes.train(training_data, training_classifications);
+
+        GaussianNaiveBayes naive_bayes;
+        naive_bayes.train(training_data, training_classifications);
+
+        printf("%-32s %9s %14s\n", "model", "accuracy", "us / sample");
+
+        Mat results(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+        int64 start;
+
+        // full covariance, one sample at a time (OpenCV)
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) = opencv_bayes.predict(testing_data.row(tsample));
+            }
+        }
+        report("full covariance (per sample)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // full covariance, whole testing set
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            batch_bayes.predict(testing_data, results);
+        }
+        report("full covariance (batch)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // diagonal covariance, one sample at a time
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+            {
+                results.at<float>(tsample, 0) = naive_bayes.predict(testing_data.ptr<float>(tsample));
+            }
+        }
+        report("diagonal covariance (per sample)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // diagonal covariance, whole testing set
+
+        start = getTickCount();
+        for (int r = 0; r < repeats; r++)
+        {
+            naive_bayes.predict(testing_data, results);
+        }
+        report("diagonal covariance (batch)", results, testing_classifications,
+               (getTickCount() - start) / getTickFrequency(), repeats);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
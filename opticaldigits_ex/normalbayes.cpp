@@ -23,6 +23,8 @@
 
 using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
+#include "normal_bayes.h"
+
 #include <stdio.h>
 
 /******************************************************************************/
@@ -37,6 +39,11 @@ using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
 // N.B. classes are integer handwritten digits in range 0-9
 
+// classify the whole testing set at once (one matrix product per class,
+// see common/normal_bayes.h) rather than one sample at a time
+
+#define USE_BATCH_PREDICTION 1  // set to 0 for CvNormalBayesClassifier::predict
+
 /******************************************************************************/
 
 // loads the sample database from file (which is a CSV text file)
@@ -122,9 +129,24 @@ int main( int argc, char** argv )
         // train bayesian classifier (using training data)
 
         printf( "\nUsing training database: %s\n\n", argv[1]);
+
+#if (USE_BATCH_PREDICTION)
+        BatchNormalBayes bayes;
+
+        bayes.train(training_data, training_classifications);
+
+        // classify every testing sample in one go
+
+        Mat batch_results;
+        int64 start = getTickCount();
+        bayes.predict(testing_data, batch_results);
+        printf("Batch prediction time : %g s\n",
+               (getTickCount() - start) / getTickFrequency());
+#else
         CvNormalBayesClassifier *bayes = new CvNormalBayesClassifier;
 
         bayes->train(training_data, training_classifications, Mat(), Mat(), false);
+#endif
 
         // perform classifier testing and report results
 
@@ -152,7 +174,11 @@ int main( int argc, char** argv )
 
             // run decision tree prediction
 
+#if (USE_BATCH_PREDICTION)
+            result = batch_results.at<float>(tsample, 0);
+#else
             result = bayes->predict(test_sample);
+#endif
 
             printf("Testing Sample %i -> class result (character %i)\n", tsample,
                    (int) result);
@@ -0,0 +1,251 @@
+// Example : incremental (online) training of the normal Bayes classifier
+// usage: prog training_data_file testing_data_file [block_size]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// CvNormalBayesClassifier::train with update=false recomputes every class
+// from all of the data, so each new batch of samples means training again on
+// everything seen so far. Here the training data arrives in blocks of
+// [block_size] rows (default 500) and each block is folded into the per class
+// statistics (count, mean, scatter matrix - see common/normal_bayes.h) in
+// time proportional to the block, the model being recomputed from the
+// statistics; this is timed against retraining from scratch after each block.
+
+// The statistics of separate parts of the data can also be merged, so the
+// training set is then split between the threads of the pool, each part's
+// statistics gathered concurrently and merged, and the resulting model
+// checked against the incrementally trained one.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "normal_bayes.h"
+#include "threadpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define DEFAULT_BLOCK_SIZE 500
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// percentage of results (a column of predicted classes) that are correct
+
+double accuracy(const Mat& results, const Mat& classes)
+{
+    int correct_class = 0;
+    for (int i = 0; i < classes.rows; i++)
+    {
+        if (fabs(results.at<float>(i, 0) - classes.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+
+    return (double) correct_class * 100 / classes.rows;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [block_size]\n", argv[0]);
+        return -1;
+    }
+
+    int block_size = (argc > 3) ? MAX(1, atoi(argv[3])) : DEFAULT_BLOCK_SIZE;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        printf( "\nUsing training database: %s (blocks of %d rows)\n", argv[1], block_size);
+        printf( "Using testing database: %s\n\n", argv[2]);
+
+        /**********************************************************************/
+
+        // online : fold in each block as it arrives, against retraining on
+        // all of the rows seen so far
+
+        BatchNormalBayes online;
+        Mat results;
+
+        printf("%10s %14s %14s %10s\n", "rows", "update (s)", "retrain (s)", "accuracy");
+
+        for (int start = 0; start < NUMBER_OF_TRAINING_SAMPLES; start += block_size)
+        {
+            int end = MIN(start + block_size, NUMBER_OF_TRAINING_SAMPLES);
+
+            int64 tick = getTickCount();
+            online.update(training_data.rowRange(start, end),
+                          training_classifications.rowRange(start, end));
+            double update_time = (getTickCount() - tick) / getTickFrequency();
+
+            tick = getTickCount();
+            CvNormalBayesClassifier retrained;
+            retrained.train(training_data.rowRange(0, end),
+                            training_classifications.rowRange(0, end), Mat(), Mat(), false);
+            double retrain_time = (getTickCount() - tick) / getTickFrequency();
+
+            online.predict(testing_data, results);
+
+            printf("%10d %14.4f %14.4f %9.2f%%\n", end, update_time, retrain_time,
+                   accuracy(results, testing_classifications));
+        }
+
+        /**********************************************************************/
+
+        // parallel : the statistics of one part of the training data per
+        // thread, gathered concurrently and then merged
+
+        ThreadPool& pool = ThreadPool::global();
+        int parts = pool.thread_count();
+        std::vector<NormalBayesStats> part_stats(parts);
+
+        int64 tick = getTickCount();
+
+        pool.parallel_for(0, parts, [&](int begin, int end)
+        {
+            for (int p = begin; p < end; p++)
+            {
+                int first = (int) ((int64) NUMBER_OF_TRAINING_SAMPLES * p / parts);
+                int last = (int) ((int64) NUMBER_OF_TRAINING_SAMPLES * (p + 1) / parts);
+                if (last > first)
+                {
+                    part_stats[p].update(training_data.rowRange(first, last),
+                                         training_classifications.rowRange(first, last));
+                }
+            }
+        }, 1);
+
+        NormalBayesStats merged;
+        for (int p = 0; p < parts; p++)
+        {
+            merged.merge(part_stats[p]);
+        }
+
+        BatchNormalBayes parallel;
+        parallel.train(merged);
+
+        double parallel_time = (getTickCount() - tick) / getTickFrequency();
+
+        // the merged model should classify (almost - up to rounding) exactly
+        // as the incrementally trained one
+
+        Mat parallel_results;
+        parallel.predict(testing_data, parallel_results);
+
+        int differences = 0;
+        for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+        {
+            if (parallel_results.at<float>(i, 0) != results.at<float>(i, 0))
+            {
+                differences++;
+            }
+        }
+
+        printf("\nMerged from %d parts : %.4f s, accuracy %.2f%%, "
+               "%d predictions differ from the online model\n",
+               parts, parallel_time, accuracy(parallel_results, testing_classifications),
+               differences);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
@@ -0,0 +1,211 @@
+// Example : scaling of parallel normal Bayes training with the training size
+// usage: prog training_data_file testing_data_file [max_copies]
+
+// For use with test / training datasets : opticaldigits_ex
+
+// Training a normal Bayes classifier is dominated by accumulating the scatter
+// matrix of each class - O(n d^2) for n samples of d attributes - which
+// CvNormalBayesClassifier does on one thread. common/normal_bayes.h instead
+// splits the rows between the threads of the pool, each accumulating its own
+// per class statistics, merged at the end. To see how this scales as the
+// number of training rows grows, the training set is enlarged to 1, 2, 4 ...
+// [max_copies] (default 16) copies of itself, each copy after the first
+// perturbed by a little Gaussian noise, and trained on by OpenCV, on one
+// thread, and on all the threads of the pool (the resulting parallel model
+// is tested on the testing set, which is left as it is).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "normal_bayes.h"
+#include "threadpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+#define DEFAULT_MAX_COPIES 16
+
+#define NOISE_SIGMA 0.5  // of the noise added to each copy (attributes 0-16)
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [max_copies]\n", argv[0]);
+        return -1;
+    }
+
+    int max_copies = (argc > 3) ? MAX(1, atoi(argv[3])) : DEFAULT_MAX_COPIES;
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        ThreadPool& pool = ThreadPool::global();
+        ThreadPool single(1);
+
+        printf( "\nUsing training database: %s (up to %d copies)\n", argv[1], max_copies);
+        printf( "Using testing database: %s\n", argv[2]);
+        printf( "Using %d threads\n\n", pool.thread_count());
+
+        printf("%10s %12s %12s %12s %9s %10s\n", "rows", "OpenCV (s)", "1 thread (s)",
+               "parallel (s)", "speedup", "accuracy");
+
+        RNG rng(12345);
+        Mat data = training_data.clone();
+        Mat classes = training_classifications.clone();
+
+        for (int copies = 1; copies <= max_copies; copies *= 2)
+        {
+            // double the training set (with noisy copies) up to this size
+
+            while (data.rows < copies * NUMBER_OF_TRAINING_SAMPLES)
+            {
+                Mat noise(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+                rng.fill(noise, RNG::NORMAL, 0, NOISE_SIGMA);
+
+                data.push_back(Mat(training_data + noise));
+                classes.push_back(training_classifications);
+            }
+
+            // OpenCV
+
+            int64 tick = getTickCount();
+            CvNormalBayesClassifier opencv_bayes;
+            opencv_bayes.train(data, classes, Mat(), Mat(), false);
+            double opencv_time = (getTickCount() - tick) / getTickFrequency();
+
+            // one thread
+
+            tick = getTickCount();
+            BatchNormalBayes serial_bayes;
+            serial_bayes.train(data, classes, single);
+            double serial_time = (getTickCount() - tick) / getTickFrequency();
+
+            // all of the threads
+
+            tick = getTickCount();
+            BatchNormalBayes parallel_bayes;
+            parallel_bayes.train(data, classes, pool);
+            double parallel_time = (getTickCount() - tick) / getTickFrequency();
+
+            // test the parallel model
+
+            Mat results;
+            parallel_bayes.predict(testing_data, results);
+
+            int correct_class = 0;
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                if (fabs(results.at<float>(i, 0) - testing_classifications.at<float>(i, 0))
+                        < FLT_EPSILON)
+                {
+                    correct_class++;
+                }
+            }
+
+            printf("%10d %12.4f %12.4f %12.4f %8.2fx %9.2f%%\n", data.rows,
+                   opencv_time, serial_time, parallel_time, serial_time / parallel_time,
+                   (double) correct_class * 100 / NUMBER_OF_TESTING_SAMPLES);
+        }
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
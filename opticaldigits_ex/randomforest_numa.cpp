@@ -0,0 +1,288 @@
+// Example : random forest (tree) learning in parallel with NUMA aware data placement
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : opticaldigits_ex
+
+// The forest is trained as several smaller forests, one per (pinned) worker
+// thread, each trained from a copy of the training set allocated on that
+// thread's NUMA node (every tree needs all of the training data, so the set
+// is replicated per node rather than sharded). Prediction is a vote over all
+// of the trees of all of the smaller forests, i.e. the same as one forest.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "threadpool.h"
+#include "numa_shards.h"
+
+#include <vector>
+using namespace std;
+
+#include <stdio.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 3823
+#define ATTRIBUTES_PER_SAMPLE 64
+#define NUMBER_OF_TESTING_SAMPLES 1797
+
+#define NUMBER_OF_CLASSES 10
+
+#define NUMBER_OF_TREES 100 // in total, over all of the threads
+
+// N.B. classes are integer handwritten digits in range 0-9
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes,
+                       int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < 64)
+            {
+
+                // first 64 elements (0-63) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+            }
+            else if (attribute == 64)
+            {
+
+                // attribute 65 is the class label {0 ... 9}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // define all the attributes as numerical
+    // alternatives are CV_VAR_CATEGORICAL or CV_VAR_ORDERED(=CV_VAR_NUMERICAL)
+    // that can be assigned on a per attribute basis
+
+    Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+    var_type.setTo(Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
+
+    // this is a classification problem (i.e. predict a discrete number of class
+    // outputs) so reset the last (+1) output var_type element to CV_VAR_CATEGORICAL
+
+    var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        // thread pool with every worker pinned to a CPU (so it stays on one node)
+
+        ThreadPool pool(0, true);
+        int first_thread = (pool.thread_count() > 1) ? 1 : 0;
+        int n_forests = pool.thread_count() - first_thread;
+        int trees_per_forest = (NUMBER_OF_TREES + n_forests - 1) / n_forests;
+
+        printf("%d threads over %d NUMA node(s), %d forests of %d trees\n",
+               pool.thread_count(), numa_nodes(), n_forests, trees_per_forest);
+
+        // copy the training set onto every node that has worker threads
+
+        NodeReplicas data_replicas;
+        NodeReplicas class_replicas;
+
+        data_replicas.replicate(training_data, pool);
+        class_replicas.replicate(training_classifications, pool);
+
+        // define the parameters for training the random forest (trees)
+
+        float priors[] = {1,1,1,1,1,1,1,1,1,1};  // weights of each classification for classes
+        // (all equal as equal samples of each digit)
+
+        CvRTParams params = CvRTParams(25, // max depth
+                                       5, // min sample count
+                                       0, // regression accuracy: N/A here
+                                       false, // compute surrogate split, no missing data
+                                       15, // max number of categories (use sub-optimal algorithm for larger numbers)
+                                       priors, // the array of priors
+                                       false,  // calculate variable importance
+                                       4,       // number of variables randomly selected at node and used to find the best split(s).
+                                       trees_per_forest,	 // max number of trees in this forest
+                                       0.01f,				// forrest accuracy
+                                       CV_TERMCRIT_ITER |	CV_TERMCRIT_EPS // termination cirteria
+                                      );
+
+        // train each of the forests on its own thread (using training data
+        // from that thread's node)
+
+        printf( "\nUsing training database: %s\n\n", argv[1]);
+
+        vector<CvRTrees*> forests(n_forests);
+
+        int64 start = getTickCount();
+        {
+            TaskGroup group(pool);
+            for (int f = 0; f < n_forests; f++)
+            {
+                int thread = first_thread + f;
+                group.run_on(thread, [&, f, thread]()
+                {
+                    // each forest needs different random bootstrap samples and
+                    // variable choices (OpenCV's random number generator is
+                    // per thread and picked up when the forest is created)
+
+                    theRNG() = RNG(0x12345678 + f);
+
+                    forests[f] = new CvRTrees;
+                    forests[f]->train(data_replicas.for_thread(thread), CV_ROW_SAMPLE,
+                                      class_replicas.for_thread(thread),
+                                      Mat(), Mat(), var_type, Mat(), params);
+                });
+            }
+            group.wait();
+        }
+        printf("Training time : %g s\n", (getTickCount() - start) / getTickFrequency());
+
+        // perform classifier testing and report results
+
+        Mat test_sample;
+        int correct_class = 0;
+        int wrong_class = 0;
+        int false_positives [NUMBER_OF_CLASSES] = {0,0,0,0,0,0,0,0,0,0};
+        int result;
+
+        printf( "\nUsing testing database: %s\n\n", argv[2]);
+
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+
+            // extract a row from the testing matrix
+
+            test_sample = testing_data.row(tsample);
+
+            // run random forest prediction : every tree of every forest votes
+
+            int votes[NUMBER_OF_CLASSES] = {0,0,0,0,0,0,0,0,0,0};
+
+            for (int f = 0; f < n_forests; f++)
+            {
+                for (int t = 0; t < forests[f]->get_tree_count(); t++)
+                {
+                    CvDTreeNode* node = forests[f]->get_tree(t)->predict(test_sample, Mat(), false);
+                    votes[(int) node->value]++;
+                }
+            }
+
+            result = 0;
+            for (int c = 1; c < NUMBER_OF_CLASSES; c++)
+            {
+                if (votes[c] > votes[result])
+                {
+                    result = c;
+                }
+            }
+
+            printf("Testing Sample %i -> class result (digit %d)\n", tsample, result);
+
+            // if the prediction and the (true) testing classification are the same
+            // (N.B. openCV uses a floating point decision tree implementation!)
+
+            if (fabs(result - testing_classifications.at<float>(tsample, 0))
+                    >= FLT_EPSILON)
+            {
+                // if they differ more than floating point error => wrong class
+
+                wrong_class++;
+
+                false_positives[result]++;
+
+            }
+            else
+            {
+
+                // otherwise correct
+
+                correct_class++;
+            }
+        }
+
+        printf( "\nResults on the testing database: %s\n"
+                "\tCorrect classification: %d (%g%%)\n"
+                "\tWrong classifications: %d (%g%%)\n",
+                argv[2],
+                correct_class, (double) correct_class*100/NUMBER_OF_TESTING_SAMPLES,
+                wrong_class, (double) wrong_class*100/NUMBER_OF_TESTING_SAMPLES);
+
+        for (int i = 0; i < NUMBER_OF_CLASSES; i++)
+        {
+            printf( "\tClass (digit %d) false postives 	%d (%g%%)\n", i,
+                    false_positives[i],
+                    (double) false_positives[i]*100/NUMBER_OF_TESTING_SAMPLES);
+        }
+
+        for (int f = 0; f < n_forests; f++)
+        {
+            delete forests[f];
+        }
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
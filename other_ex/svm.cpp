@@ -0,0 +1,295 @@
+// Example : Support Vector Machine (SVM) learning
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : other_ex/wdbc.{train|test}
+
+// The wdbc attributes range from around 0.05 to 2500, so unscaled the
+// largest of them dominate the RBF kernel (and SVM training converges
+// slowly). With USE_STANDARDIZATION every attribute is rescaled to zero mean
+// and unit variance : the statistics are accumulated as the training data is
+// read (a single pass) and the same scaling is applied to each testing
+// sample as it is read.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "standardize.h"
+
+#include <stdio.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 449
+#define ATTRIBUTES_PER_SAMPLE 30  // not the first two as patient ID and class
+#define NUMBER_OF_TESTING_SAMPLES 120
+
+#define NUMBER_OF_CLASSES 2
+
+static char CLASSES[2] = {'B', 'M'};  // class B = 0, class M = 1
+
+// rescale every attribute to zero mean, unit variance (using the statistics
+// of the training data) before training and testing
+
+#define USE_STANDARDIZATION 1  // set to 0 to use the attributes as they are
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+// (if given, each sample is also added to the statistics in stats and then
+// rescaled in place by standardizer as soon as it has been read)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes, int n_samples,
+                       RunningStats* stats, const Standardizer* standardizer)
+{
+    char tmpc;
+    float tmpf;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 2); attribute++)
+        {
+            if (attribute == 0)
+            {
+                fscanf(f, "%f,", &tmpf);
+
+                // ignore attribute 0 (as it's the patient ID)
+
+                continue;
+            }
+            else if (attribute == 1)
+            {
+
+                // attribute 2 (in the database) is the classification
+                // record 1 = M = malignant
+                // record 0 = B = benign
+
+                fscanf(f, "%c,", &tmpc);
+
+                switch(tmpc)
+                {
+                case 'M':
+                    classes.at<float>(line, 0) = 1.0;
+                    break;
+                case 'B':
+                    classes.at<float>(line, 0) = 0.0;
+                    break;
+                default:
+                    printf("ERROR: unexpected class in file %s\n",  filename);
+                    return 0; // all not OK
+                }
+
+                // printf("%c,", tmpc);
+            }
+            else
+            {
+                fscanf(f, "%f,", &tmpf);
+                data.at<float>(line, (attribute - 2)) = tmpf;
+                //printf("%f,", tmpf);
+            }
+        }
+        fscanf(f, "\n");
+        //printf("\n");
+
+        if (stats)
+        {
+            stats->add(data.ptr<float>(line));
+        }
+        if (standardizer)
+        {
+            standardizer->apply(data.ptr<float>(line));
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // attribute statistics (gathered while loading the training data) and
+    // the scaling they give
+
+    RunningStats stats(ATTRIBUTES_PER_SAMPLE);
+    Standardizer standardizer;
+
+    // load training and testing data sets
+
+#if (USE_STANDARDIZATION)
+    RunningStats* training_stats = &stats;
+    const Standardizer* testing_scaling = &standardizer;
+#else
+    RunningStats* training_stats = NULL;
+    const Standardizer* testing_scaling = NULL;
+#endif
+
+    bool loaded = read_data_from_csv(argv[1], training_data, training_classifications,
+                                     NUMBER_OF_TRAINING_SAMPLES, training_stats, NULL);
+
+#if (USE_STANDARDIZATION)
+    if (loaded)
+    {
+        // scaling from the training data statistics : applied to the training
+        // data now and to each testing sample as it is read
+
+        standardizer.fit(stats);
+        standardizer.apply(training_data);
+    }
+#endif
+
+    loaded = loaded && read_data_from_csv(argv[2], testing_data, testing_classifications,
+                                          NUMBER_OF_TESTING_SAMPLES, NULL, testing_scaling);
+
+    if (loaded)
+    {
+        // define the parameters for training the SVM
+
+        CvSVMParams params = CvSVMParams(
+                                 CvSVM::C_SVC,   // Type of SVM, here N classes (see manual)
+                                 CvSVM::RBF,     // kernel type (see manual)
+                                 0.0,			// kernel parameter (degree) for poly kernel only
+                                 1.0 / ATTRIBUTES_PER_SAMPLE, // kernel parameter (gamma) for poly/rbf kernel only
+                                 0.0,			// kernel parameter (coef0) for poly/sigmoid kernel only
+                                 10,				// SVM optimization parameter C
+                                 0,				// SVM optimization parameter nu (not used for N classe SVM)
+                                 0,				// SVM optimization parameter p (not used for N classe SVM)
+                                 NULL,			// class wieghts (or priors)
+
+                                 // termination criteria for learning algorithm
+
+                                 cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 100000, 0.000001)
+
+                             );
+
+        // train SVM classifier (using training data)
+
+        printf( "\nUsing training database: %s\n\n", argv[1]);
+        CvSVM* svm = new CvSVM;
+
+        int64 start = getTickCount();
+        svm->train(training_data, training_classifications, Mat(), Mat(), params);
+        printf("Training time : %g s\n", (getTickCount() - start) / getTickFrequency());
+
+        // get the number of support vectors used to define the SVM decision boundary
+
+        printf("Number of support vectors for trained SVM = %i\n", svm->get_support_vector_count());
+
+        // perform classifier testing and report results
+
+        Mat test_sample;
+        int correct_class = 0;
+        int wrong_class = 0;
+        int false_positives [NUMBER_OF_CLASSES];
+        float result;
+
+        // zero the false positive counters in a simple loop
+
+        for (int i = 0; i < NUMBER_OF_CLASSES; i++)
+        {
+            false_positives[i] = 0;
+        }
+
+        printf( "\nUsing testing database: %s\n\n", argv[2]);
+
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+
+            // extract a row from the testing matrix
+
+            test_sample = testing_data.row(tsample);
+
+            // run SVM classifier
+
+            result = svm->predict(test_sample);
+
+            printf("Testing Sample %i -> class result (character %c)\n", tsample,
+                   CLASSES[((int) result)]);
+
+            // if the prediction and the (true) testing classification are the same
+            // (within the bounds of floating point error for cross-platfom safety)
+
+            if (fabs(result - testing_classifications.at<float>(tsample, 0))
+                    >= FLT_EPSILON)
+            {
+                // if they differ more than floating point error => wrong class
+
+                wrong_class++;
+
+                false_positives[((int) result)]++;
+
+            }
+            else
+            {
+
+                // otherwise correct
+
+                correct_class++;
+            }
+        }
+
+        printf( "\nResults on the testing database: %s (%s attributes)\n"
+                "\tCorrect classification: %d (%g%%)\n"
+                "\tWrong classifications: %d (%g%%)\n",
+                argv[2], USE_STANDARDIZATION ? "standardized" : "unscaled",
+                correct_class, (double) correct_class*100/NUMBER_OF_TESTING_SAMPLES,
+                wrong_class, (double) wrong_class*100/NUMBER_OF_TESTING_SAMPLES);
+
+        for (int i = 0; i < NUMBER_OF_CLASSES; i++)
+        {
+            printf( "\tClass (character %c) false postives 	%d (%g%%)\n", CLASSES[i],
+                    false_positives[i],
+                    (double) false_positives[i]*100/NUMBER_OF_TESTING_SAMPLES);
+        }
+
+        delete svm;
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
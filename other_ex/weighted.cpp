@@ -0,0 +1,357 @@
+// Example : cost-sensitive (weighted) learning for imbalanced classes
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : other_ex/wdbc.{train|test}
+
+// wdbc has almost twice as many benign (B) as malignant (M) samples. Rather
+// than duplicating the malignant samples to balance the classes, each sample
+// is weighted so that both classes carry equal total weight - and the weights
+// are passed to each classifier in the form it accepts : per sample weights
+// (neural network), neighbour votes weighted by each neighbour's own weight
+// (kNN), priors (decision tree, boosted trees) and class weights (SVM). Each
+// classifier is trained and tested both unweighted and weighted, and the
+// recall of each class is reported alongside the overall accuracy.
+
+// A data file may also carry an extra (last) column giving the weight of
+// each sample (e.g. a cost, or the number of rows it stands for) - these are
+// multiplied by the class balancing (wdbc has none, so all are 1). Only the
+// neural network and kNN use them sample by sample : OpenCV's decision tree,
+// boosted trees and SVM accept only per class weights, so for these each
+// class is weighted by the total of its sample weights (samples of one class
+// with different weights are trained on alike - see common/sample_weights.h).
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "csv_rows.h"
+#include "gemm_knn.h"
+#include "sample_weights.h"
+#include "standardize.h"
+
+#include <stdio.h>
+
+/******************************************************************************/
+// global definitions (for speed and ease of use)
+
+#define NUMBER_OF_TRAINING_SAMPLES 449
+#define ATTRIBUTES_PER_SAMPLE 30  // not the first two as patient ID and class
+#define NUMBER_OF_TESTING_SAMPLES 120
+
+#define NUMBER_OF_CLASSES 2
+
+static char CLASSES[2] = {'B', 'M'};  // class B = 0, class M = 1
+
+#define NEAREST_NEIGHBOURS 5  // k for kNN
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file) : patient
+// ID, class, attributes and then (optionally) the weight of the sample
+
+int read_data_from_csv(const char* filename, Mat& data, Mat& classes, Mat& weights,
+                       int n_samples)
+{
+    // if we can't read the input file then return 0
+
+    CSVRowReader reader(filename);
+    if (!reader.is_open())
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    data = Mat(n_samples, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    classes = Mat(n_samples, 1, CV_32FC1);
+    weights = Mat(n_samples, 1, CV_32FC1);
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+        // attributes are fields 2 onwards (field 0 is the patient ID)
+
+        if (!reader.next_row() ||
+                !reader.numbers(2, ATTRIBUTES_PER_SAMPLE, data.ptr<float>(line)))
+        {
+            printf("ERROR: too few samples or attributes in file %s\n",  filename);
+            return 0; // all not OK
+        }
+
+        // field 1 is the classification
+        // record 1 = M = malignant
+        // record 0 = B = benign
+
+        switch(reader.text(1)[0])
+        {
+        case 'M':
+            classes.at<float>(line, 0) = 1.0;
+            break;
+        case 'B':
+            classes.at<float>(line, 0) = 0.0;
+            break;
+        default:
+            printf("ERROR: unexpected class in file %s\n",  filename);
+            return 0; // all not OK
+        }
+
+        // any field after the attributes is the weight of the sample
+
+        weights.at<float>(line, 0) = (reader.fields() > (ATTRIBUTES_PER_SAMPLE + 2))
+                                     ? reader.number(ATTRIBUTES_PER_SAMPLE + 2) : 1.0f;
+    }
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// report overall accuracy and the recall of each class of a set of
+// predictions (one per testing sample)
+
+static void report(const char* classifier, const char* weighting,
+                   const Mat& predicted, const Mat& truth)
+{
+    int correct = 0;
+    int class_total[NUMBER_OF_CLASSES] = {0, 0};
+    int class_correct[NUMBER_OF_CLASSES] = {0, 0};
+
+    for (int i = 0; i < truth.rows; i++)
+    {
+        int actual = (int) truth.at<float>(i, 0);
+
+        class_total[actual]++;
+
+        // (within the bounds of floating point error for cross-platfom safety)
+
+        if (fabs(predicted.at<float>(i, 0) - truth.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct++;
+            class_correct[actual]++;
+        }
+    }
+
+    printf("%-16s %-12s %9.2f%%", classifier, weighting, (double) correct * 100 / truth.rows);
+    for (int c = 0; c < NUMBER_OF_CLASSES; c++)
+    {
+        printf(" %9.2f%%", (double) class_correct[c] * 100 / MAX(class_total[c], 1));
+    }
+    printf("\n");
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training and testing data storage matrices (attributes,
+    // classifications and sample weights)
+
+    Mat training_data, training_classifications, training_weights;
+    Mat testing_data, testing_classifications, testing_weights;
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications,
+                           training_weights, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications,
+                               testing_weights, NUMBER_OF_TESTING_SAMPLES))
+    {
+        // the SVM, neural network and kNN need comparably scaled attributes
+        // (the trees are unaffected by scaling)
+
+        Standardizer standardizer;
+        standardizer.fit(training_data);
+        standardizer.apply(training_data);
+        standardizer.apply(testing_data);
+
+        // attributes are numerical, the class is categorical
+
+        Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
+        var_type.setTo(Scalar(CV_VAR_NUMERICAL) );
+        var_type.at<uchar>(ATTRIBUTES_PER_SAMPLE, 0) = CV_VAR_CATEGORICAL;
+
+        // neural network outputs : 1 for the class of the sample, 0 otherwise
+
+        Mat training_outputs = Mat::zeros(NUMBER_OF_TRAINING_SAMPLES, NUMBER_OF_CLASSES, CV_32FC1);
+        for (int i = 0; i < NUMBER_OF_TRAINING_SAMPLES; i++)
+        {
+            training_outputs.at<float>(i, (int) training_classifications.at<float>(i, 0)) = 1.0;
+        }
+
+        // kNN : the neighbours are the same whatever the weighting (their
+        // rows in the training data are kept, for their sample weights)
+
+        GemmKNearest knn(training_data, training_classifications);
+        Mat knn_results, neighbour_responses, neighbours;
+        knn.find_nearest(testing_data, NEAREST_NEIGHBOURS, knn_results,
+                         neighbour_responses, NULL, &neighbours);
+
+        printf("\nUsing training database: %s\n", argv[1]);
+        printf("Using testing database: %s\n\n", argv[2]);
+
+        printf("%-16s %-12s %10s", "classifier", "weighting", "correct");
+        for (int c = 0; c < NUMBER_OF_CLASSES; c++)
+        {
+            printf("  recall (%c)", CLASSES[c]);
+        }
+        printf("\n");
+
+        Mat predicted = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+        for (int weighted = 0; weighted <= 1; weighted++)
+        {
+            // unweighted : every sample has weight 1; weighted : the sample
+            // weights from the file, rescaled so that both classes have
+            // equal total weight
+
+            ClassWeights class_weights;
+            class_weights.fit(training_classifications,
+                              weighted ? training_weights : Mat(), weighted != 0);
+
+            const char* weighting = weighted ? "balanced" : "none";
+
+            if (weighted)
+            {
+                printf("\n");
+            }
+
+            // (the decision tree, boosted trees and SVM see only the total
+            // weight of each class)
+
+            std::vector<float> priors = class_weights.priors();
+
+            // 1. decision tree : priors
+
+            CvDTreeParams tree_params = CvDTreeParams(8, // max depth
+                                        5, // min sample count
+                                        0, // regression accuracy: N/A here
+                                        false, // compute surrogate split, no missing data
+                                        15, // max number of categories
+                                        10, // the number of cross-validation folds
+                                        true, // use 1SE rule => smaller tree
+                                        false, // throw away the pruned tree branches
+                                        &priors[0] // the total weight of each class
+                                                      );
+
+            CvDTree dtree;
+            dtree.train(training_data, CV_ROW_SAMPLE, training_classifications,
+                        Mat(), Mat(), var_type, Mat(), tree_params);
+
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                predicted.at<float>(i, 0) = (float) dtree.predict(testing_data.row(i))->value;
+            }
+            report("decision tree", weighting, predicted, testing_classifications);
+
+            // 2. boosted trees : priors
+
+            CvBoostParams boost_params = CvBoostParams(CvBoost::REAL, // boosting type
+                                         100, // number of weak classifiers
+                                         0.95, // trim rate
+                                         5, // max depth of trees
+                                         false, // compute surrogate split, no missing data
+                                         &priors[0] );
+
+            CvBoost boost;
+            boost.train(training_data, CV_ROW_SAMPLE, training_classifications,
+                        Mat(), Mat(), var_type, Mat(), boost_params);
+
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                predicted.at<float>(i, 0) = boost.predict(testing_data.row(i));
+            }
+            report("boosted trees", weighting, predicted, testing_classifications);
+
+            // 3. SVM : class weights (scaling C for each class)
+
+            Mat svm_weights = class_weights.svm_class_weights();
+            CvMat svm_class_weights = svm_weights;
+
+            CvSVMParams svm_params = CvSVMParams(
+                                         CvSVM::C_SVC,   // Type of SVM, here N classes (see manual)
+                                         CvSVM::RBF,     // kernel type (see manual)
+                                         0.0,			// kernel parameter (degree) for poly kernel only
+                                         1.0 / ATTRIBUTES_PER_SAMPLE, // kernel parameter (gamma) for poly/rbf kernel only
+                                         0.0,			// kernel parameter (coef0) for poly/sigmoid kernel only
+                                         10,				// SVM optimization parameter C
+                                         0,				// SVM optimization parameter nu (not used for N classe SVM)
+                                         0,				// SVM optimization parameter p (not used for N classe SVM)
+                                         &svm_class_weights, // class weights
+                                         cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 100000, 0.000001)
+                                     );
+
+            CvSVM svm;
+            svm.train(training_data, training_classifications, Mat(), Mat(), svm_params);
+
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                predicted.at<float>(i, 0) = svm.predict(testing_data.row(i));
+            }
+            report("SVM", weighting, predicted, testing_classifications);
+
+            // 4. neural network : per sample weights
+
+            Mat layers = Mat(1, 3, CV_32SC1);
+            layers.at<int>(0, 0) = ATTRIBUTES_PER_SAMPLE;
+            layers.at<int>(0, 1) = 10;
+            layers.at<int>(0, 2) = NUMBER_OF_CLASSES;
+
+            CvANN_MLP nnetwork;
+            nnetwork.create(layers, CvANN_MLP::SIGMOID_SYM, 0.6, 1);
+
+            CvANN_MLP_TrainParams nn_params = CvANN_MLP_TrainParams(
+                                                  cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001),
+                                                  CvANN_MLP_TrainParams::BACKPROP,
+                                                  0.1,
+                                                  0.1);
+
+            nnetwork.train(training_data, training_outputs,
+                           class_weights.sample_weights(training_classifications,
+                                   weighted ? training_weights : Mat()),
+                           Mat(), nn_params);
+
+            Mat outputs = Mat(1, NUMBER_OF_CLASSES, CV_32FC1);
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                Point max_loc;
+                nnetwork.predict(testing_data.row(i), outputs);
+                minMaxLoc(outputs, 0, 0, 0, &max_loc);
+                predicted.at<float>(i, 0) = (float) max_loc.x;
+            }
+            report("neural network", weighting, predicted, testing_classifications);
+
+            // 5. kNN : each neighbour's vote weighted by its own sample weight
+
+            Mat knn_weights = class_weights.sample_weights(training_classifications,
+                              weighted ? training_weights : Mat());
+
+            for (int i = 0; i < NUMBER_OF_TESTING_SAMPLES; i++)
+            {
+                predicted.at<float>(i, 0) =
+                    class_weights.vote(neighbours.ptr<int>(i), NEAREST_NEIGHBOURS,
+                                       training_classifications, knn_weights);
+            }
+            report("kNN", weighting, predicted, testing_classifications);
+        }
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
@@ -13,6 +13,8 @@
 
 using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
+#include "pca_stage.h"
+
 #include <stdio.h>
 
 /******************************************************************************/
@@ -25,6 +27,12 @@ using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
 // N.B. classes are spoken alphabetric letters A-Z labelled 1 -> 26
 
+// reduce the attributes to their leading principal components (PCA) before
+// training and testing (see also pca_tradeoff.cpp)
+
+#define USE_PCA 0           // set to 1 to train / test on the PCA projection
+#define PCA_COMPONENTS 64   // number of principal components kept
+
 /******************************************************************************/
 
 // loads the sample database from file (which is a CSV text file)
@@ -116,6 +124,25 @@ int main( int argc, char** argv )
     if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
             read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
     {
+#if (USE_PCA)
+        // fit the projection to the training data then project (in batch)
+        // both the training and testing data
+
+        PCAStage pca;
+        pca.fit(training_data, PCA_COMPONENTS);
+        pca.transform(training_data, training_data);
+        pca.transform(testing_data, testing_data);
+
+        printf("PCA : %d attributes -> %d components (%g%% of the variance retained)\n",
+               ATTRIBUTES_PER_SAMPLE, pca.components(), pca.retained_variance() * 100);
+
+        // the (numerical) projected attributes replace the original ones
+
+        var_type = Mat(pca.components() + 1, 1, CV_8U );
+        var_type.setTo(Scalar(CV_VAR_NUMERICAL) );
+        var_type.at<uchar>(pca.components(), 0) = CV_VAR_CATEGORICAL;
+#endif
+
         // define the parameters for training the decision tree
 
         float *priors = NULL;  // weights of each classification for classes
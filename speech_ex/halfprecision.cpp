@@ -0,0 +1,293 @@
+// Example : half precision (fp16) storage of the speech data, comparing kNN,
+// SVM and neural network classification from fp16 samples with the usual
+// (CV_32FC1) classification
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : speech_ex
+
+// The training and testing data are loaded straight into half precision
+// (16 bit) matrices - half the memory of the float matrices - and converted
+// back to float a tile at a time inside the kNN distance, SVM kernel and
+// neural network kernels (see common/half_float.h). The saving is in the
+// storage used at prediction time only : OpenCV trains from float data, so
+// the float training set is needed (and, here, loaded alongside the half
+// precision copies) to train each classifier. Each classifier is trained
+// once, as usual, and then tested on both the float and the half precision
+// testing data; the agreement column gives the proportion of the testing
+// samples for which both gave the same class. So that the times compare the
+// storage alone, the half precision predictions run on a single thread, as
+// do OpenCV's. Build with -mf16c (or -march=native) to use the hardware
+// conversion instructions.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "half_float.h"
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+#define NUMBER_OF_TRAINING_SAMPLES 6238
+#define ATTRIBUTES_PER_SAMPLE 617
+#define NUMBER_OF_TESTING_SAMPLES 1559
+
+#define NUMBER_OF_CLASSES 26
+
+// N.B. classes are spoken alphabetric letters A-Z labelled 1 -> 26
+
+#define NEAREST_NEIGHBOURS 7  // k for kNN
+#define HIDDEN_NODES 64       // in the neural network's single hidden layer
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes, int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 617 elements (0-616) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 617 is the class label {1 ... 26} == {A-Z}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// prints a line of results for one set of predictions (one per testing
+// sample), with the proportion that agree with a reference set
+
+static void report(const char* classifier, const char* storage, size_t bytes,
+                   double time, const Mat& predicted, const Mat& reference,
+                   const Mat& truth)
+{
+    int correct = 0;
+    int agree = 0;
+
+    for (int i = 0; i < truth.rows; i++)
+    {
+        if (fabs(predicted.at<float>(i, 0) - truth.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            correct++;
+        }
+        if (fabs(predicted.at<float>(i, 0) - reference.at<float>(i, 0)) < FLT_EPSILON)
+        {
+            agree++;
+        }
+    }
+
+    printf("%-14s  %-7s  %15.2f  %13.3f  %8.2f%%  %8.2f%%\n", classifier, storage,
+           (double) bytes / (1024 * 1024), time,
+           (double) correct * 100 / truth.rows, (double) agree * 100 / truth.rows);
+}
+
+// class of each row of network outputs (one output per class, labelled 1 -> 26)
+
+static Mat output_classes(const Mat& outputs)
+{
+    Mat classes = Mat(outputs.rows, 1, CV_32FC1);
+    for (int i = 0; i < outputs.rows; i++)
+    {
+        Point max_loc;
+        minMaxLoc(outputs.row(i), 0, 0, 0, &max_loc);
+        classes.at<float>(i, 0) = (float) (max_loc.x + 1);
+    }
+    return classes;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file\n", argv[0]);
+        return -1;
+    }
+
+    // load the data as floats and (separately) straight into half precision
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    Mat half_training_data, half_testing_data, half_classifications, half_test_classifications;
+
+    if (!(read_data_from_csv(argv[1], training_data, training_classifications,
+                             NUMBER_OF_TRAINING_SAMPLES)
+            && read_data_from_csv(argv[2], testing_data, testing_classifications,
+                                  NUMBER_OF_TESTING_SAMPLES)
+            && load_half_csv(argv[1], NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE,
+                             half_training_data, half_classifications)
+            && load_half_csv(argv[2], NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE,
+                             half_testing_data, half_test_classifications)))
+    {
+        // not OK : main returns -1
+
+        printf("ERROR: cannot read data from %s and %s\n", argv[1], argv[2]);
+        return -1;
+    }
+
+    printf( "\nUsing training database: %s\n", argv[1]);
+    printf( "Using testing database: %s\n", argv[2]);
+    printf( "Half precision conversion : %s\n\n",
+            half_float_hardware() ? "F16C instructions" : "software");
+
+    size_t float_bytes = (training_data.total() + testing_data.total()) * sizeof(float);
+    size_t half_bytes = (half_training_data.total() + half_testing_data.total()) * sizeof(ushort);
+
+    printf("%-14s  %-7s  %15s  %13s  %9s  %9s\n", "classifier", "storage",
+           "data size (MB)", "test time (s)", "correct", "agreement");
+
+    Mat float_results, half_results, neighbour_responses, dists;
+
+    // (the half precision predictions on one thread, as OpenCV's)
+
+    ThreadPool single(1);
+
+    // 1. kNN : the training samples are the model, so they are held in half
+    // precision as well
+
+    CvKNearest knn(training_data, training_classifications);
+    HalfKNearest half_knn(half_training_data, half_classifications);
+
+    int64 start = getTickCount();
+    knn.find_nearest(testing_data, NEAREST_NEIGHBOURS, float_results, neighbour_responses, dists);
+    double time = (getTickCount() - start) / getTickFrequency();
+    report("kNN", "float", float_bytes, time, float_results, float_results,
+           testing_classifications);
+
+    start = getTickCount();
+    half_knn.find_nearest(half_testing_data, NEAREST_NEIGHBOURS, half_results, neighbour_responses,
+                          single);
+    time = (getTickCount() - start) / getTickFrequency();
+    report("kNN", "half", half_bytes, time, half_results, float_results,
+           testing_classifications);
+
+    // 2. SVM (RBF and sigmoid kernels) : the support vectors are also held
+    // in half precision
+
+    int kernel_types[2] = { CvSVM::RBF, CvSVM::SIGMOID };
+    const char* kernel_names[2] = { "SVM (RBF)", "SVM (sigmoid)" };
+
+    for (int kernel = 0; kernel < 2; kernel++)
+    {
+        CvSVMParams params = CvSVMParams(CvSVM::C_SVC, kernel_types[kernel],
+                                         0.0, 1.0 / ATTRIBUTES_PER_SAMPLE, 0.0, 10, 0, 0, NULL,
+                                         cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001));
+        HalfSVM svm;
+        svm.train(training_data, training_classifications, Mat(), Mat(), params);
+        svm.store_half();
+
+        size_t sv_bytes = (size_t) svm.get_support_vector_count() * svm.get_var_count();
+
+        start = getTickCount();
+        float_results = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            float_results.at<float>(tsample, 0) = svm.predict(testing_data.row(tsample));
+        }
+        time = (getTickCount() - start) / getTickFrequency();
+        report(kernel_names[kernel], "float",
+               testing_data.total() * sizeof(float) + sv_bytes * sizeof(float),
+               time, float_results, float_results, testing_classifications);
+
+        start = getTickCount();
+        svm.predict_half(half_testing_data, half_results, single);
+        time = (getTickCount() - start) / getTickFrequency();
+        report(kernel_names[kernel], "half",
+               half_testing_data.total() * sizeof(ushort) + sv_bytes * sizeof(ushort),
+               time, half_results, float_results, testing_classifications);
+    }
+
+    // 3. neural network (one output per class)
+
+    Mat training_outputs = Mat::zeros(NUMBER_OF_TRAINING_SAMPLES, NUMBER_OF_CLASSES, CV_32FC1);
+    for (int i = 0; i < NUMBER_OF_TRAINING_SAMPLES; i++)
+    {
+        training_outputs.at<float>(i, ((int) training_classifications.at<float>(i, 0)) - 1) = 1.0;
+    }
+
+    Mat layers = Mat(1, 3, CV_32SC1);
+    layers.at<int>(0, 0) = ATTRIBUTES_PER_SAMPLE;
+    layers.at<int>(0, 1) = HIDDEN_NODES;
+    layers.at<int>(0, 2) = NUMBER_OF_CLASSES;
+
+    HalfMLP nnetwork;
+    nnetwork.create(layers, CvANN_MLP::SIGMOID_SYM, 0.6, 1);
+    nnetwork.train(training_data, training_outputs, Mat(), Mat(),
+                   CvANN_MLP_TrainParams(cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 300, 0.000001),
+                                         CvANN_MLP_TrainParams::RPROP, 0.1, FLT_EPSILON));
+
+    Mat outputs;
+
+    start = getTickCount();
+    nnetwork.predict(testing_data, outputs);
+    float_results = output_classes(outputs);
+    time = (getTickCount() - start) / getTickFrequency();
+    report("neural network", "float", testing_data.total() * sizeof(float), time,
+           float_results, float_results, testing_classifications);
+
+    start = getTickCount();
+    nnetwork.predict_half(half_testing_data, outputs, single);
+    half_results = output_classes(outputs);
+    time = (getTickCount() - start) / getTickFrequency();
+    report("neural network", "half", half_testing_data.total() * sizeof(ushort), time,
+           half_results, float_results, testing_classifications);
+
+    // all matrix memory free by destructors
+
+    // all OK : main returns 0
+
+    return 0;
+}
+/******************************************************************************/
@@ -0,0 +1,209 @@
+// Example : kNN on the speech data with distances by matrix multiplication
+// usage: prog training_data_file testing_data_file
+
+// For use with test / training datasets : speech_ex
+
+// With 617 attributes per sample most of the kNN time goes on distances.
+// Here the squared distances |x|^2 + |y|^2 - 2 x.y between tiles of testing
+// samples and tiles of training samples are computed with one matrix
+// product per pair of tiles (see common/gemm_knn.h), the training sample
+// norms once up front, keeping the k nearest per query tile by tile. This is
+// timed against CvKNearest (one query at a time as in knn.cpp, and the whole
+// testing set in one call), on one thread and on the whole thread pool; the
+// agreement column gives the proportion of the testing samples classified
+// the same as by CvKNearest.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "gemm_knn.h"
+#include "threadpool.h"
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+#define NUMBER_OF_TRAINING_SAMPLES 6238
+#define ATTRIBUTES_PER_SAMPLE 617
+#define NUMBER_OF_TESTING_SAMPLES 1559
+
+#define NUMBER_OF_CLASSES 26
+
+// N.B. classes are spoken alphabetric letters A-Z labelled 1 -> 26
+
+#define NEAREST_NEIGHBOURS 7  // k for kNN
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes, int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 617 elements (0-616) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 617 is the class label {1 ... 26} == {A-Z}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// report the accuracy of results (a column of predicted classes), the time
+// taken, and the agreement with reference (another column of classes)
+
+void report(const char* name, const Mat& results, const Mat& classes,
+            const Mat& reference, double seconds, double baseline_seconds)
+{
+    int correct_class = 0;
+    int agree = 0;
+    for (int i = 0; i < classes.rows; i++)
+    {
+        correct_class += (fabs(results.at<float>(i, 0) - classes.at<float>(i, 0)) < FLT_EPSILON);
+        agree += (results.at<float>(i, 0) == reference.at<float>(i, 0));
+    }
+
+    printf("%-28s %8.2f%% %10.4f %12.2f %8.2fx %9.2f%%\n", name,
+           (double) correct_class * 100 / classes.rows, seconds,
+           seconds * 1e6 / classes.rows, baseline_seconds / seconds,
+           (double) agree * 100 / classes.rows);
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file\n", argv[0]);
+        return -1;
+    }
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        ThreadPool& pool = ThreadPool::global();
+        ThreadPool single(1);
+
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n", argv[2]);
+        printf( "Using k = %d, %d threads\n\n", NEAREST_NEIGHBOURS, pool.thread_count());
+
+        CvKNearest knn;
+        knn.train(training_data, training_classifications, Mat(), false, NEAREST_NEIGHBOURS);
+
+        GemmKNearest gemm_knn(training_data, training_classifications);
+
+        printf("%-28s %9s %10s %12s %9s %10s\n", "kNN", "accuracy", "time (s)",
+               "us / query", "speedup", "agreement");
+
+        Mat results(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+        Mat reference, neighbour_responses;
+
+        // CvKNearest, whole testing set (the reference)
+
+        int64 start = getTickCount();
+        knn.find_nearest(testing_data, NEAREST_NEIGHBOURS, &reference);
+        double batch_time = (getTickCount() - start) / getTickFrequency();
+
+        // CvKNearest, one query at a time
+
+        start = getTickCount();
+        for (int tsample = 0; tsample < NUMBER_OF_TESTING_SAMPLES; tsample++)
+        {
+            results.at<float>(tsample, 0) = knn.find_nearest(testing_data.row(tsample),
+                                                             NEAREST_NEIGHBOURS);
+        }
+        double per_query_time = (getTickCount() - start) / getTickFrequency();
+
+        report("CvKNearest (per query)", results, testing_classifications, reference,
+               per_query_time, per_query_time);
+        report("CvKNearest (batch)", reference, testing_classifications, reference,
+               batch_time, per_query_time);
+
+        // matrix multiplication, one thread then all of the threads
+
+        start = getTickCount();
+        gemm_knn.find_nearest(testing_data, NEAREST_NEIGHBOURS, results, neighbour_responses,
+                              NULL, NULL, single);
+        report("GEMM tiles (1 thread)", results, testing_classifications, reference,
+               (getTickCount() - start) / getTickFrequency(), per_query_time);
+
+        start = getTickCount();
+        gemm_knn.find_nearest(testing_data, NEAREST_NEIGHBOURS, results, neighbour_responses,
+                              NULL, NULL, pool);
+        report("GEMM tiles (thread pool)", results, testing_classifications, reference,
+               (getTickCount() - start) / getTickFrequency(), per_query_time);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
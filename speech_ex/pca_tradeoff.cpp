@@ -0,0 +1,247 @@
+// Example : accuracy vs. speed of SVM and decision tree learning on PCA
+// projections with varying numbers of principal components
+// usage: prog training_data_file testing_data_file [exact|randomized]
+
+// For use with test / training datasets : speech_ex
+
+// For each number of components the PCA projection is fitted to the training
+// data, both sets are projected and then an SVM and a decision tree are
+// trained and tested on the result - the final row of the table is for the
+// original (unprojected) 617 attributes. The projection is found exactly by
+// default, or by randomized SVD if "randomized" is given.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "pca_stage.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************/
+
+#define NUMBER_OF_TRAINING_SAMPLES 6238
+#define ATTRIBUTES_PER_SAMPLE 617
+#define NUMBER_OF_TESTING_SAMPLES 1559
+
+#define NUMBER_OF_CLASSES 26
+
+// N.B. classes are spoken alphabetric letters A-Z labelled 1 -> 26
+
+// numbers of principal components tried (0 = no PCA, all attributes)
+
+static const int components_tried[] = {8, 16, 32, 64, 128, 256, 0};
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes, int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 617 elements (0-616) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 617 is the class label {1 ... 26} == {A-Z}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// percentage of the testing samples classified correctly
+
+double percent_correct(const Mat& predictions, const Mat& testing_classifications)
+{
+    int correct_class = 0;
+    for (int tsample = 0; tsample < predictions.rows; tsample++)
+    {
+        if (fabs(predictions.at<float>(tsample, 0) - testing_classifications.at<float>(tsample, 0))
+                < FLT_EPSILON)
+        {
+            correct_class++;
+        }
+    }
+    return (double) correct_class * 100 / predictions.rows;
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    // define training data storage matrices (one for attribute examples, one
+    // for classifications)
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat training_classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+
+    //define testing data storage matrices
+
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    // load training and testing data sets
+
+    if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
+            read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
+    {
+        PCAStage::Method method = ((argc > 3) && (strcmp(argv[3], "randomized") == 0))
+                                  ? PCAStage::RANDOMIZED : PCAStage::EXACT;
+
+        // SVM and decision tree parameters as the manual settings of svm.cpp
+        // and decisiontree.cpp (SVM grid search would dominate the timings)
+
+        CvSVMParams svm_params = CvSVMParams(
+                                     CvSVM::C_SVC,   // Type of SVM, here N classes (see manual)
+                                     CvSVM::LINEAR,  // kernel type (see manual)
+                                     0.0,			// kernel parameter (degree) for poly kernel only
+                                     0.0,			// kernel parameter (gamma) for poly/rbf kernel only
+                                     0.0,			// kernel parameter (coef0) for poly/sigmoid kernel only
+                                     10,				// SVM optimization parameter C
+                                     0,				// SVM optimization parameter nu (not used for N classe SVM)
+                                     0,				// SVM optimization parameter p (not used for N classe SVM)
+                                     NULL,			// class wieghts (or priors)
+                                     cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001)
+                                 );
+
+        CvDTreeParams dtree_params = CvDTreeParams(25, // max depth
+                                     5, // min sample count
+                                     0, // regression accuracy: N/A here
+                                     false, // compute surrogate split, no missing data
+                                     15, // max number of categories (use sub-optimal algorithm for larger numbers)
+                                     15, // the number of cross-validation folds
+                                     false, // use 1SE rule => smaller tree
+                                     false, // throw away the pruned tree branches
+                                     NULL // the array of priors
+                                                  );
+
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n", argv[2]);
+        printf( "PCA by %s\n\n", (method == PCAStage::EXACT) ? "eigen decomposition (exact)" : "randomized SVD");
+
+        printf("components  variance  PCA (s)  |  SVM train (s)  test (s)  correct  "
+               "|  tree train (s)  test (s)  correct\n");
+
+        for (size_t i = 0; i < sizeof(components_tried) / sizeof(components_tried[0]); i++)
+        {
+            Mat train = training_data;
+            Mat test = testing_data;
+            double retained = 1.0;
+
+            // fit and apply the projection (timed together)
+
+            int64 start = getTickCount();
+            if (components_tried[i] > 0)
+            {
+                PCAStage pca;
+                pca.fit(training_data, components_tried[i], method);
+                pca.transform(training_data, train);
+                pca.transform(testing_data, test);
+                retained = pca.retained_variance();
+            }
+            double pca_time = (getTickCount() - start) / getTickFrequency();
+
+            // SVM
+
+            CvSVM svm;
+            Mat predictions = Mat(test.rows, 1, CV_32FC1);
+
+            start = getTickCount();
+            svm.train(train, training_classifications, Mat(), Mat(), svm_params);
+            double svm_train_time = (getTickCount() - start) / getTickFrequency();
+
+            start = getTickCount();
+            for (int tsample = 0; tsample < test.rows; tsample++)
+            {
+                predictions.at<float>(tsample, 0) = svm.predict(test.row(tsample));
+            }
+            double svm_test_time = (getTickCount() - start) / getTickFrequency();
+            double svm_correct = percent_correct(predictions, testing_classifications);
+
+            // decision tree (all attributes numerical, class categorical)
+
+            Mat var_type = Mat(train.cols + 1, 1, CV_8U );
+            var_type.setTo(Scalar(CV_VAR_NUMERICAL) );
+            var_type.at<uchar>(train.cols, 0) = CV_VAR_CATEGORICAL;
+
+            CvDTree dtree;
+
+            start = getTickCount();
+            dtree.train(train, CV_ROW_SAMPLE, training_classifications,
+                        Mat(), Mat(), var_type, Mat(), dtree_params);
+            double dtree_train_time = (getTickCount() - start) / getTickFrequency();
+
+            start = getTickCount();
+            for (int tsample = 0; tsample < test.rows; tsample++)
+            {
+                predictions.at<float>(tsample, 0) =
+                    (float) dtree.predict(test.row(tsample), Mat(), false)->value;
+            }
+            double dtree_test_time = (getTickCount() - start) / getTickFrequency();
+            double dtree_correct = percent_correct(predictions, testing_classifications);
+
+            printf("%10d  %7.1f%%  %7.3f  |  %13.3f  %8.3f  %6.2f%%  |  %14.3f  %8.3f  %6.2f%%\n",
+                   train.cols, retained * 100, pca_time,
+                   svm_train_time, svm_test_time, svm_correct,
+                   dtree_train_time, dtree_test_time, dtree_correct);
+        }
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    return -1;
+}
+/******************************************************************************/
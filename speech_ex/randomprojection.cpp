@@ -0,0 +1,229 @@
+// Example : sparse random projection of the speech data during loading,
+// comparing SVM and kNN learning on the projected (reduced) attributes with
+// learning on all of the original attributes
+// usage: prog training_data_file testing_data_file [dimensions] [seed]
+
+// For use with test / training datasets : speech_ex
+
+// Each sample is projected from 617 attributes to a few (default 64) as soon
+// as its line of the file has been read - only the projected rows are ever
+// stored. The projection matrix is random (Achlioptas-style, very sparse) so
+// nothing has to be fitted to the data first, unlike PCA (see
+// pca_tradeoff.cpp), but the same seed must be used for the training and
+// testing data.
+
+// License : LGPL - http://www.gnu.org/licenses/lgpl.html
+
+#include <cv.h>       // opencv general include file
+#include <ml.h>		  // opencv machine learning include file
+
+using namespace cv; // OpenCV API is in the C++ "cv" namespace
+
+#include "random_projection.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+
+#define NUMBER_OF_TRAINING_SAMPLES 6238
+#define ATTRIBUTES_PER_SAMPLE 617
+#define NUMBER_OF_TESTING_SAMPLES 1559
+
+#define NUMBER_OF_CLASSES 26
+
+// N.B. classes are spoken alphabetric letters A-Z labelled 1 -> 26
+
+#define DEFAULT_DIMENSIONS 64     // attributes after projection
+#define DEFAULT_SEED 0x12345678   // of the random projection matrix
+
+/******************************************************************************/
+
+// loads the sample database from file (which is a CSV text file)
+
+
+int read_data_from_csv(const char* filename, Mat data, Mat classes, int n_samples )
+{
+    float tmp;
+
+    // if we can't read the input file then return 0
+    FILE* f = fopen( filename, "r" );
+    if( !f )
+    {
+        printf("ERROR: cannot read file %s\n",  filename);
+        return 0; // all not OK
+    }
+
+    // for each sample in the file
+
+    for(int line = 0; line < n_samples; line++)
+    {
+
+        // for each attribute on the line in the file
+
+        for(int attribute = 0; attribute < (ATTRIBUTES_PER_SAMPLE + 1); attribute++)
+        {
+            if (attribute < ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // first 617 elements (0-616) in each line are the attributes
+
+                fscanf(f, "%f,", &tmp);
+                data.at<float>(line, attribute) = tmp;
+
+
+            }
+            else if (attribute == ATTRIBUTES_PER_SAMPLE)
+            {
+
+                // attribute 617 is the class label {1 ... 26} == {A-Z}
+
+                fscanf(f, "%f,", &tmp);
+                classes.at<float>(line, 0) = tmp;
+            }
+        }
+    }
+
+    fclose(f);
+
+    return 1; // all OK
+}
+
+/******************************************************************************/
+
+// trains and tests an SVM and kNN classifier on the given data, printing a
+// line of results for each
+
+void compare_classifiers(const char* name, double load_time,
+                         const Mat& training_data, const Mat& training_classifications,
+                         const Mat& testing_data, const Mat& testing_classifications)
+{
+    CvSVMParams params = CvSVMParams(CvSVM::C_SVC, CvSVM::LINEAR,
+                                     0.0, 0.0, 0.0, 10, 0, 0, NULL,
+                                     cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, 0.000001));
+    CvSVM svm;
+    CvKNearest knn;
+
+    int64 start = getTickCount();
+    svm.train(training_data, training_classifications, Mat(), Mat(), params);
+    double svm_train_time = (getTickCount() - start) / getTickFrequency();
+
+    start = getTickCount();
+    knn.train(training_data, training_classifications, Mat(), false, 32, false);
+    double knn_train_time = (getTickCount() - start) / getTickFrequency();
+
+    int svm_correct = 0;
+    int knn_correct = 0;
+    double svm_test_time = 0;
+    double knn_test_time = 0;
+
+    for (int tsample = 0; tsample < testing_data.rows; tsample++)
+    {
+        Mat test_sample = testing_data.row(tsample);
+        float expected = testing_classifications.at<float>(tsample, 0);
+
+        start = getTickCount();
+        float result = svm.predict(test_sample);
+        svm_test_time += (getTickCount() - start) / getTickFrequency();
+
+        if (fabs(result - expected) < FLT_EPSILON)
+        {
+            svm_correct++;
+        }
+
+        start = getTickCount();
+        result = knn.find_nearest(test_sample, 7);
+        knn_test_time += (getTickCount() - start) / getTickFrequency();
+
+        if (fabs(result - expected) < FLT_EPSILON)
+        {
+            knn_correct++;
+        }
+    }
+
+    printf("%-10s  %10d  %13.3f  SVM  %14.3f  %13.3f  %8.2f%%\n", name, training_data.cols,
+           load_time, svm_train_time, svm_test_time,
+           (double) svm_correct * 100 / testing_data.rows);
+    printf("%-10s  %10d  %13.3f  kNN  %14.3f  %13.3f  %8.2f%%\n", name, training_data.cols,
+           load_time, knn_train_time, knn_test_time,
+           (double) knn_correct * 100 / testing_data.rows);
+}
+
+/******************************************************************************/
+
+int main( int argc, char** argv )
+{
+    // lets just check the version first
+
+    printf ("OpenCV version %s (%d.%d.%d)\n",
+            CV_VERSION,
+            CV_MAJOR_VERSION, CV_MINOR_VERSION, CV_SUBMINOR_VERSION);
+
+    if (argc < 3)
+    {
+        printf("usage: %s training_data_file testing_data_file [dimensions] [seed]\n", argv[0]);
+        return -1;
+    }
+
+    int dimensions = (argc > 3) ? atoi(argv[3]) : DEFAULT_DIMENSIONS;
+    uint64 seed = (argc > 4) ? (uint64) strtoull(argv[4], NULL, 0) : DEFAULT_SEED;
+
+    // load the data projected as it is read
+
+    SparseRandomProjection projection(ATTRIBUTES_PER_SAMPLE, dimensions, seed);
+
+    Mat projected_training_data, projected_testing_data;
+    Mat training_classifications, testing_classifications;
+
+    int64 start = getTickCount();
+    bool projected_ok =
+        load_projected_csv(argv[1], NUMBER_OF_TRAINING_SAMPLES, projection,
+                           projected_training_data, training_classifications)
+        && load_projected_csv(argv[2], NUMBER_OF_TESTING_SAMPLES, projection,
+                              projected_testing_data, testing_classifications);
+    double projected_load_time = (getTickCount() - start) / getTickFrequency();
+
+    // and (for comparison) in full
+
+    Mat training_data = Mat(NUMBER_OF_TRAINING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat testing_data = Mat(NUMBER_OF_TESTING_SAMPLES, ATTRIBUTES_PER_SAMPLE, CV_32FC1);
+    Mat classifications = Mat(NUMBER_OF_TRAINING_SAMPLES, 1, CV_32FC1);
+    Mat test_classifications = Mat(NUMBER_OF_TESTING_SAMPLES, 1, CV_32FC1);
+
+    start = getTickCount();
+    bool full_ok =
+        read_data_from_csv(argv[1], training_data, classifications, NUMBER_OF_TRAINING_SAMPLES)
+        && read_data_from_csv(argv[2], testing_data, test_classifications, NUMBER_OF_TESTING_SAMPLES);
+    double full_load_time = (getTickCount() - start) / getTickFrequency();
+
+    if (projected_ok && full_ok)
+    {
+        printf( "\nUsing training database: %s\n", argv[1]);
+        printf( "Using testing database: %s\n", argv[2]);
+        printf( "Sparse random projection %d -> %d attributes (seed 0x%llx, %d non-zero entries)\n\n",
+                ATTRIBUTES_PER_SAMPLE, dimensions, (unsigned long long) seed,
+                projection.non_zeros());
+
+        printf("%-10s  %10s  %13s  %-3s  %14s  %13s  %9s\n", "data", "attributes",
+               "load time (s)", "", "train time (s)", "test time (s)", "correct");
+
+        compare_classifiers("original", full_load_time,
+                            training_data, classifications,
+                            testing_data, test_classifications);
+        compare_classifiers("projected", projected_load_time,
+                            projected_training_data, training_classifications,
+                            projected_testing_data, testing_classifications);
+
+        // all matrix memory free by destructors
+
+        // all OK : main returns 0
+
+        return 0;
+    }
+
+    // not OK : main returns -1
+
+    printf("ERROR: cannot read data from %s and %s\n", argv[1], argv[2]);
+    return -1;
+}
+/******************************************************************************/
@@ -15,6 +15,8 @@
 
 using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
+#include "pca_stage.h"
+
 #include <stdio.h>
 
 /******************************************************************************/
@@ -23,6 +25,13 @@ using namespace cv; // OpenCV API is in the C++ "cv" namespace
 
 #define USE_OPENCV_GRID_SEARCH_AUTOTRAIN 1  // set to 0 to set SVM parameters manually
 
+// reduce the attributes to their leading principal components (PCA) before
+// training and testing (see also pca_tradeoff.cpp)
+
+#define USE_PCA 0           // set to 1 to train / test on the PCA projection
+#define PCA_COMPONENTS 64   // number of principal components kept
+#define PCA_MODEL_FILE "isolet_svm_pca.xml" // trained SVM + projection saved here
+
 /******************************************************************************/
 
 #define NUMBER_OF_TRAINING_SAMPLES 6238
@@ -111,6 +120,19 @@ int main( int argc, char** argv )
     if (read_data_from_csv(argv[1], training_data, training_classifications, NUMBER_OF_TRAINING_SAMPLES) &&
             read_data_from_csv(argv[2], testing_data, testing_classifications, NUMBER_OF_TESTING_SAMPLES))
     {
+#if (USE_PCA)
+        // fit the projection to the training data then project (in batch)
+        // both the training and testing data
+
+        PCAStage pca;
+        pca.fit(training_data, PCA_COMPONENTS);
+        pca.transform(training_data, training_data);
+        pca.transform(testing_data, testing_data);
+
+        printf("PCA : %d attributes -> %d components (%g%% of the variance retained)\n",
+               ATTRIBUTES_PER_SAMPLE, pca.components(), pca.retained_variance() * 100);
+#endif
+
         // define the parameters for training the SVM (kernel + SVMtype type used for auto-training,
         // other parameters for manual only)
 
@@ -170,6 +192,15 @@ int main( int argc, char** argv )
 
         printf("Number of support vectors for trained SVM = %i\n", svm->get_support_vector_count());
 
+#if (USE_PCA)
+        // store the projection with the trained SVM (new samples need both)
+
+        FileStorage fs(PCA_MODEL_FILE, FileStorage::WRITE);
+        svm->write(*fs, "svm");
+        pca.write(fs);
+        printf("SVM and PCA projection saved to %s\n", PCA_MODEL_FILE);
+#endif
+
         // perform classifier testing and report results
 
         Mat test_sample;